@@ -1,7 +1,25 @@
+#include "hlt/alloc_stats.hpp"
+#include "hlt/dropoff_sites.hpp"
+#include "hlt/economy.hpp"
+#include "hlt/explore_rates.hpp"
+#include "hlt/fleet_stats.hpp"
 #include "hlt/game.hpp"
+#include "hlt/halite_field.hpp"
+#include "hlt/inspiration_forecast.hpp"
+#include "hlt/mining.hpp"
+#include "hlt/occupancy_forecast.hpp"
+#include "hlt/opponent_profiler.hpp"
+#include "hlt/reservation_table.hpp"
+#include "hlt/return_schedule.hpp"
+#include "hlt/target_table.hpp"
+#include "hlt/thread_pool.hpp"
+#include "hlt/trace.hpp"
+#include "hlt/walk_batch.hpp"
+#include "auction/Auction.h"
 #include "hungarian/Hungarian.h"
 
 #include <bits/stdc++.h>
+#include <unistd.h>
 
 using namespace std;
 using namespace hlt;
@@ -22,25 +40,152 @@ const double ALPHA = 0.35;
 double ewma = MAX_HALITE;
 bool should_spawn_ewma = true;
 
+// Halite each ship takes off the map per turn, sampled with the EWMA. With
+// --economy 1, spawns and dropoffs go by fast-forwarding the economy instead
+// of the EWMA's payback rule. Off until ab_run_game.py settles it.
+double drain = -1.0;
+Halite drain_halite = -1;
+bool use_economy = false;
+const int SPAWN_LATER = 10;
+
+// Our fleet's trips over the last QuantileSketch::WINDOW turns, logged at the
+// end of the game. With --trips 1, the economy takes its trip length from
+// here once enough trips have been seen.
+FleetStats fleet;
+bool use_trip_stats = true;
+const int TRIP_SAMPLES = 10;
+
 bool started_hard_return = false;
 
 double average_halite_left = 0.0;
 
 unordered_map<EntityId, int> last_moved;
 
+// Deterministic mode (--seed). Walks are budgeted by count instead of time so
+// that the same frames always produce the same commands.
+bool deterministic = false;
+size_t deterministic_walks = 2000;
+mt19937 rng;
+
+// Engine used to value each ship's first move (--planner walk|dp|mcts).
+enum Planner { RANDOM_WALK, VALUE_ITERATION, TREE_SEARCH };
+Planner planner = RANDOM_WALK;
+
+// Whether random walks run WALK_BATCH at a time in batch_walks() (--batch 1).
+// Batches walk in float and change decisions, so they are off until
+// ab_run_game.py finds them no worse.
+bool batch = false;
+
+// Threads used to build the explorer cost matrix (--threads).
+unsigned threads = max(1u, thread::hardware_concurrency());
+unique_ptr<ThreadPool> pool;
+
+// Fleets smaller than this solve their move groups on the main thread.
+const size_t PARALLEL_MOVE_SHIPS = 32;
+
+// Solver for the explorer-target assignment (--solver hungarian|auction).
+// The auction scales to a larger --padding.
+bool auction = false;
+
+// Explorer cost matrices, written as <dir>/<turn>.txt with --dump-costs <dir>
+// so that solvers can be tested on real turns.
+string dump_costs;
+void dump_cost_matrix(const vector<vector<double>>& cost) {
+    ofstream out(dump_costs + "/" + to_string(game.turn_number) + ".txt");
+    out << cost.size() << ' ' << (cost.empty() ? 0 : cost[0].size()) << '\n'
+        << setprecision(17);
+    for (const vector<double>& row : cost) {
+        for (size_t j = 0; j < row.size(); ++j)
+            out << row[j] << (j + 1 < row.size() ? ' ' : '\n');
+    }
+}
+
 inline Halite extracted(Halite h) {
     return (h + EXTRACT_RATIO - 1) / EXTRACT_RATIO;
 }
 
 shared_ptr<Dropoff> future_dropoff;
+// Enemy occupancy over the next few turns. With --forecast 1, cells next to
+// an enemy that it is this unlikely to step onto are not treated as unsafe.
+OccupancyForecast forecast;
+bool use_forecast = false;
+const float FORECAST_UNLIKELY = 0.05;
+
+// How each opponent has been behaving. With --profile 1, opponents that have
+// been seen to ram rarely (or often) are assumed never (or always) to ram.
+OpponentProfiler profiler;
+bool use_profiles = false;
+const double RAM_RARE = 0.05;
+const double RAM_OFTEN = 0.3;
+const double RAM_SAMPLES = 20;
+
+// An enemy is expected to ram a ship holding more than its halite plus this.
+double ram_margin(PlayerId player, double margin) {
+    if (!use_profiles) return margin;
+    const RollingRate& ram = profiler[player].ram;
+    if (ram.events < RAM_SAMPLES) return margin;
+    if (ram.rate() <= RAM_RARE) return -MAX_HALITE;
+    if (ram.rate() >= RAM_OFTEN) return MAX_HALITE;
+    return margin;
+}
+
+// Inspiration over the next few turns, from the occupancy forecast. With
+// --inspire 1, explorers value a target's inspiration on arrival rather than
+// now; off until ab_run_game.py settles it.
+InspirationForecast inspiration;
+bool use_inspiration = false;
+
+// Blurred halite, kept up to date from the cells each frame changes. With
+// --blur 1, explorers count this share of a target's neighbourhood average
+// as extra profit for a trip there.
+HaliteField field;
+bool use_blur = false;
+const double NEIGHBOURHOOD_SHARE = 0.25;
+
+// Ships last counted into the cells' close_allies and close_enemies, with
+// whether each was ours. The next turn takes exactly these back out.
+vector<pair<Position, bool>> counted_ships;
+
+// Adds sign to the close ship counts of the cells within INSPIRATION_RADIUS
+// of p.
+void count_close_ship(Position p, bool ally, int sign) {
+    const int IR = INSPIRATION_RADIUS;
+    for (int dx = -IR; dx <= IR; ++dx) {
+        for (int dy = -IR; dy <= IR; ++dy) {
+            if (abs(dx) + abs(dy) > IR) continue;
+            MapCell* cell = game.game_map->at(Position(p.x + dx, p.y + dy));
+            (ally ? cell->close_allies : cell->close_enemies) += sign;
+        }
+    }
+}
+
+// Our bases, the planned dropoff included, that the cells' closest_base was
+// last computed for.
+vector<Position> closest_base_bases;
+
 set<Position> future_collisions;
 map<Position, int> recent_collisions;
 
-// Fluorine JSON.
-stringstream flog;
-void message(Position p, string c) {
-    flog << "{\"t\": " << game.turn_number << ", \"x\": " << p.x
-         << ", \"y\": " << p.y << ", \"color\": \"" << c << "\"}," << endl;
+// Decisions, streamed by every player (--trace) to --trace-path, by default
+// bot-<id>-<pid>.trace so that games run side by side keep their own traces.
+// trace_to_flog.py turns a trace into Fluorine JSON.
+TraceWriter trace;
+string trace_path;
+bool tracing = true;
+void message(Position p, TraceColour c) {
+    trace.write(game.turn_number, TRACE_MARK, c, -1, p);
+}
+
+// Heap use per phase and per turn, in builds configured with -DALLOC_STATS=ON.
+// The first phase of a turn also counts the previous turn's output.
+alloc::Counts turn_allocations;
+void log_allocations(const char* phase) {
+    if (!alloc::enabled()) return;
+    const alloc::Counts counts = alloc::take();
+    turn_allocations += counts;
+    log::log("Allocations:", phase, counts.allocations, "new",
+             counts.frees, "delete", counts.bytes, "bytes", counts.peak,
+             "peak");
 }
 
 inline bool hard_stuck(shared_ptr<Ship> ship) {
@@ -48,7 +193,17 @@ inline bool hard_stuck(shared_ptr<Ship> ship) {
     return ship->halite < left / MOVE_COST_RATIO;
 }
 
+// A ship's task, read without inserting, so that the pool can call this.
+Task task_of(EntityId id) {
+    auto it = tasks.find(id);
+    return it == tasks.end() ? Task() : it->second;
+}
+
+// Who is closer to each occupied cell, stored by the first safe_to_move() query
+// of the cell. While safe_to_move_read_only is set (on the pool), queries only
+// read it; see fill_safe_to_move_cache().
 position_map<vector<int>> safe_to_move_cache;
+bool safe_to_move_read_only = false;
 bool safe_to_move(shared_ptr<Ship> ship, Position p, bool print = false) {
     unique_ptr<GameMap>& game_map = game.game_map;
     MapCell* cell = game_map->at(p);
@@ -58,13 +213,17 @@ bool safe_to_move(shared_ptr<Ship> ship, Position p, bool print = false) {
     if (ship->owner == cell->ship->owner) return false;
     if (cell->has_structure() && cell->structure->id != -2)
         return cell->structure->owner == game.my_id;
-    if (tasks[ship->id] == HARD_RETURN) return true;
+    if (task_of(ship->id) == HARD_RETURN) return true;
 
     // They shouldn't be walking over this.
     if (!cell->really_there &&
         MAX_HALITE - cell->ship->halite < extracted(cell->halite)) {
         return true;
     }
+    if (use_forecast && !cell->really_there &&
+        forecast.at(game_map->normalize(p), 1) < FORECAST_UNLIKELY) {
+        return true;
+    }
     Halite dropped = ship->halite + cell->ship->halite;
     Halite already = cell->halite;
     if (cell->inspired()) {
@@ -73,15 +232,20 @@ bool safe_to_move(shared_ptr<Ship> ship, Position p, bool print = false) {
     }
 
     // Estimate who is closer.
-    if (!safe_to_move_cache.count(p)) {
-        vector<int> closeness(4);
+    vector<int> closeness;
+    auto cached = safe_to_move_cache.find(p);
+    if (cached != safe_to_move_cache.end()) {
+        closeness = cached->second;
+    } else {
+        closeness.assign(4, 0);
         for (auto player : game.players) {
             for (auto& it : player->ships) {
                 if (it.second->id == cell->ship->id) continue;
                 if (MAX_HALITE - it.second->halite <
                     extracted(dropped + already))
                     continue;
-                if (player->id == game.my_id && tasks[it.second->id] != EXPLORE)
+                if (player->id == game.my_id &&
+                    task_of(it.second->id) != EXPLORE)
                     continue;
                 int d = game_map->calc_dist(p, it.second->position);
                 if (d > 3) continue;
@@ -93,10 +257,9 @@ bool safe_to_move(shared_ptr<Ship> ship, Position p, bool print = false) {
         }
         for (size_t i = 1; i < closeness.size(); ++i)
             closeness[i] += closeness[i - 1];
-        safe_to_move_cache[p] = move(closeness);
+        if (!safe_to_move_read_only) safe_to_move_cache.emplace(p, closeness);
     }
 
-    auto closeness = safe_to_move_cache[p];
     if (MAX_HALITE - ship->halite < extracted(dropped + already)) {
         int d = game_map->calc_dist(p, ship->position);
         for (size_t i = d; i < closeness.size(); ++i) --closeness[i];
@@ -109,21 +272,37 @@ bool safe_to_move(shared_ptr<Ship> ship, Position p, bool print = false) {
                  "Closeness:", safe_close, "Dropped:", dropped);
     }
 
-    if (!safe_close || ship->halite > cell->ship->halite + MAX_HALITE * 0.25)
+    if (!safe_close ||
+        cell->ship->halite <
+            ship->halite + ram_margin(cell->ship->owner, -MAX_HALITE * 0.25)) {
         return false;
+    }
     if (game.players.size() == 2) return true;
     return dropped >= min(1.5 * SHIP_COST, 3 * average_halite_left);
 }
 
-void bfs(position_map<Halite>& dist, shared_ptr<Ship> ship) {
+// Stores the closeness of every occupied cell that a query by ship reaches,
+// before code on the pool queries the cache without filling it.
+void fill_safe_to_move_cache(shared_ptr<Ship> ship) {
+    for (const vector<MapCell>& cells : game.game_map->cells) {
+        for (const MapCell& cell : cells)
+            if (cell.is_occupied()) safe_to_move(ship, cell.position);
+    }
+}
+
+// Cheapest burn to each cell over shortest paths from the ship, or 1e3 if it
+// cannot get there. Indexed by y * width + x.
+void bfs(vector<int32_t>& dist, shared_ptr<Ship> ship) {
     unique_ptr<GameMap>& game_map = game.game_map;
+    const int width = game_map->width;
+    auto index = [&](Position p) { return p.y * width + p.x; };
 
-    dist.clear();
-    position_map<bool> vis;
+    dist.assign(width * game_map->height, -1);
+    vector<bool> vis(dist.size());
 
     queue<Position> q;
     q.push(ship->position);
-    dist[ship->position] = 0;
+    dist[index(ship->position)] = 0;
     while (!q.empty()) {
         Position p = q.front();
         q.pop();
@@ -138,15 +317,129 @@ void bfs(position_map<Halite>& dist, shared_ptr<Ship> ship) {
                 continue;
             }
 
-            if (!dist.count(pp) || dist[pp] > dist[p] + cost)
-                dist[pp] = dist[p] + cost;
+            int32_t& d = dist[index(pp)];
+            if (d < 0 || d > dist[index(p)] + cost) d = dist[index(p)] + cost;
 
-            if (!vis[pp]) {
+            if (!vis[index(pp)]) {
                 q.push(pp);
-                vis[pp] = true;
+                vis[index(pp)] = true;
             }
         }
     }
+
+    for (int32_t& d : dist)
+        if (d < 0) d = 1e3;
+}
+
+// Cooperative return paths. Returning ships plan a path to their base over the
+// next RESERVE_TURNS turns that avoids the cells (and swaps) other returners
+// have reserved, reserve it, and keep it for as long as they follow it
+// (--reserve 1, off until ab_run_game.py settles it).
+const int RESERVE_TURNS = 8;
+bool reserve = false;
+ReservationTable reservations;
+
+// Path[k] is where the ship should be on turn + k.
+struct ReturnPlan {
+    int turn;
+    vector<Position> path;
+};
+unordered_map<EntityId, ReturnPlan> return_plans;
+
+void release_plan(EntityId id) {
+    auto it = return_plans.find(id);
+    if (it == return_plans.end()) return;
+    const ReturnPlan& plan = it->second;
+    for (size_t k = 0; k < plan.path.size(); ++k)
+        reservations.release(plan.path[k], plan.turn + k, id);
+    return_plans.erase(it);
+}
+
+// Whether the ship may go from p to q between turn and turn + 1.
+bool open_move(shared_ptr<Ship> ship, Position p, Position q, int turn) {
+    const EntityId other = reservations.at(q, turn + 1);
+    if (other >= 0 && other != ship->id) return false;
+    const EntityId swap = reservations.at(q, turn);
+    if (swap >= 0 && swap != ship->id && reservations.at(p, turn + 1) == swap)
+        return false;
+
+    // Enemies can only be predicted for the coming turn.
+    if (turn != game.turn_number) return true;
+    MapCell* cell = game.game_map->at(q);
+    return !cell->is_occupied() || cell->ship->owner == game.my_id ||
+           safe_to_move(ship, q);
+}
+
+// Whether the ship is where its plan says and can still take the next step.
+bool on_plan(shared_ptr<Ship> ship) {
+    auto it = return_plans.find(ship->id);
+    if (it == return_plans.end()) return false;
+    const ReturnPlan& plan = it->second;
+    const size_t k = game.turn_number - plan.turn;
+    return k + 1 < plan.path.size() && plan.path[k] == ship->position &&
+           open_move(ship, plan.path[k], plan.path[k + 1], game.turn_number);
+}
+
+// Where a ship on its plan goes next turn.
+Position planned_move(shared_ptr<Ship> ship) {
+    const ReturnPlan& plan = return_plans[ship->id];
+    return plan.path[game.turn_number - plan.turn + 1];
+}
+
+// Earliest arrival at ship->next within RESERVE_TURNS, burning the least
+// halite among those, by search over (cell, turn) layers. Cells that cannot
+// reach the base in the turns left are pruned.
+bool plan_return(shared_ptr<Ship> ship) {
+    release_plan(ship->id);
+
+    unique_ptr<GameMap>& game_map = game.game_map;
+    const Position base = ship->next;
+    const int width = game_map->width;
+    auto position = [&](int cell) {
+        return Position(cell % width, cell / width);
+    };
+
+    // Halite burned reaching each cell at each turn, and the cell before.
+    vector<map<int, pair<Halite, int>>> layers(RESERVE_TURNS + 1);
+    layers[0][ship->position.y * width + ship->position.x] = {0, -1};
+    for (int t = 0; t < RESERVE_TURNS; ++t) {
+        for (auto& it : layers[t]) {
+            const Position p = position(it.first);
+            const Halite burn = game_map->at(p)->halite / MOVE_COST_RATIO;
+            for (Direction d : {Direction::NORTH, Direction::SOUTH,
+                                Direction::EAST, Direction::WEST,
+                                Direction::STILL}) {
+                if (d != Direction::STILL && t == 0 && ship->halite < burn)
+                    continue;
+                const Position q = game_map->normalize(p.doff(d));
+                if (t + 1 + game_map->calc_dist(q, base) > RESERVE_TURNS)
+                    continue;
+                if (!open_move(ship, p, q, game.turn_number + t)) continue;
+
+                const Halite burned =
+                    it.second.first + (d == Direction::STILL ? 0 : burn);
+                auto next = layers[t + 1].emplace(q.y * width + q.x,
+                                                  make_pair(burned, it.first));
+                if (!next.second && burned < next.first->second.first)
+                    next.first->second = {burned, it.first};
+            }
+        }
+
+        auto arrival = layers[t + 1].find(base.y * width + base.x);
+        if (arrival == layers[t + 1].end()) continue;
+
+        ReturnPlan& plan = return_plans[ship->id];
+        plan.turn = game.turn_number;
+        plan.path.assign(t + 2, base);
+        for (int k = t + 1, cell = arrival->first; k > 0; --k) {
+            cell = layers[k][cell].second;
+            plan.path[k - 1] = position(cell);
+        }
+        for (size_t k = 0; k < plan.path.size(); ++k)
+            reservations.reserve(plan.path[k], plan.turn + k, ship->id);
+        return true;
+    }
+    return false;
 }
 
 struct WalkState {
@@ -163,15 +456,9 @@ struct WalkState {
     double turns = 0;
     vector<Direction> walk;
 
-    void mine() {
-        Halite mined = extracted(map_halite);
-        mined = min(mined, MAX_HALITE - ship_halite);
-        ship_halite += mined;
-        if (game.game_map->at(p)->inspired()) {
-            ship_halite += INSPIRED_BONUS_MULTIPLIER * mined;
-            ship_halite = min(ship_halite, MAX_HALITE);
-        }
-        map_halite -= mined;
+    void mine(int turns = 1) {
+        mining::mine(ship_halite, map_halite, turns,
+                     game.game_map->at(p)->inspired());
     }
 
     void move(Direction d) {
@@ -201,54 +488,492 @@ struct WalkState {
     }
 };
 
-WalkState random_walk(shared_ptr<Ship> ship, Position d) {
-    unique_ptr<GameMap>& game_map = game.game_map;
+void final_mine(WalkState& ws) {
+    if (game.turn_number + ws.turns > MAX_TURNS) ws.ship_halite = 0;
 
-    WalkState ws(ship);
+    // Mine while another turn improves the walk, for at most 10 turns.
+    const Halite ship_halite = ws.ship_halite, map_halite = ws.map_halite;
+    const double turns = ws.turns;
+    double value = ws.evaluate();
+    int mines = 0;
+    for (; mines < 10; ++mines) {
+        ws.ship_halite = ship_halite;
+        ws.map_halite = map_halite;
+        ws.turns = turns + mines + 1;
+        ws.mine(mines + 1);
+        const double next = ws.evaluate();
+        if (max(0.0, value) >= next) break;
+        value = next;
+    }
 
-    for (size_t i = 0; ws.p != d && i <= 50; ++i) {
-        auto moves =
-            game_map->get_moves(ws.p, d, ws.ship_halite, ws.map_halite);
+    ws.ship_halite = ship_halite;
+    ws.map_halite = map_halite;
+    ws.turns = turns + mines;
+    ws.mine(mines);
+}
 
-        auto rit = remove_if(moves.begin(), moves.end(), [&](Direction d) {
-            return !safe_to_move(ship, ws.p.doff(d));
-        });
-        moves.erase(rit, moves.end());
-        if (moves.empty()) {
-            // TODO: Add sideways moves when only waking in a line.
-            // We try to add all moves.
-            for (Direction d : ALL_CARDINALS) {
-                if (safe_to_move(ship, ws.p.doff(d))) moves.push_back(d);
-            }
+// A walk ends at d, after 51 moves, or once an explorer should return.
+bool walk_done(shared_ptr<Ship> ship, const WalkState& ws, Position d) {
+    if (ws.p == d || ws.turns > 50) return true;
+    return ws.turns && tasks[ship->id] == EXPLORE &&
+           ws.ship_halite > HALITE_RETURN;
+}
+
+vector<Direction> walk_moves(shared_ptr<Ship> ship, const WalkState& ws,
+                             Position d) {
+    unique_ptr<GameMap>& game_map = game.game_map;
+
+    auto moves = game_map->get_moves(ws.p, d, ws.ship_halite, ws.map_halite);
+
+    auto rit = remove_if(moves.begin(), moves.end(), [&](Direction d) {
+        return !safe_to_move(ship, ws.p.doff(d));
+    });
+    moves.erase(rit, moves.end());
+    if (moves.empty()) {
+        // TODO: Add sideways moves when only waking in a line.
+        // We try to add all moves.
+        for (Direction d : ALL_CARDINALS) {
+            if (safe_to_move(ship, ws.p.doff(d))) moves.push_back(d);
         }
+    }
+    return moves;
+}
+
+void continue_walk(shared_ptr<Ship> ship, Position d, WalkState& ws) {
+    while (!walk_done(ship, ws, d)) {
+        auto moves = walk_moves(ship, ws, d);
         if (moves.empty()) break;
 
-        Direction d = moves[rand() % moves.size()];
+        Direction d = moves[rng() % moves.size()];
         ws.walk.push_back(d);
 
         ws.move(d);
+    }
+}
+
+WalkState random_walk(shared_ptr<Ship> ship, Position d) {
+    WalkState ws(ship);
+    continue_walk(ship, d, ws);
+
+    final_mine(ws);
+
+    if (ws.walk.empty()) ws.walk.push_back(Direction::STILL);
+    return ws;
+}
+
+// The cells a walk toward d can visit, i moves along x_move and j moves along
+// y_move from s for 0 <= i <= nx and 0 <= j <= ny.
+struct WalkBox {
+    Position s;
+    int nx, ny;
+    Direction x_move = Direction::STILL, y_move = Direction::STILL;
 
-        if (tasks[ship->id] == EXPLORE && ws.ship_halite > HALITE_RETURN) break;
+    WalkBox(Position s, Position d) : s(s) {
+        unique_ptr<GameMap>& game_map = game.game_map;
+        nx = game_map->calc_dist(s, Position(d.x, s.y));
+        ny = game_map->calc_dist(s, Position(s.x, d.y));
+        auto x_moves =
+            game_map->get_moves(s, Position(d.x, s.y), MAX_HALITE, 0);
+        auto y_moves =
+            game_map->get_moves(s, Position(s.x, d.y), MAX_HALITE, 0);
+        if (!x_moves.empty()) x_move = x_moves.front();
+        if (!y_moves.empty()) y_move = y_moves.front();
     }
 
-    if (game.turn_number + ws.turns > MAX_TURNS) ws.ship_halite = 0;
+    Position at(int i, int j) const {
+        const Position ux = Position().doff(x_move);
+        const Position uy = Position().doff(y_move);
+        return game.game_map->normalize(
+            Position(s.x + i * ux.x + j * uy.x, s.y + i * ux.y + j * uy.y));
+    }
+};
+
+// Flattens the ship's walk box for batch_walks(), returning the directions of
+// its move codes.
+array<Direction, 3> fill_walk_grid(WalkGrid& grid, shared_ptr<Ship> ship,
+                                   Position d) {
+    const WalkBox box(ship->position, d);
+    grid.resize(box.nx, box.ny);
+    for (int i = 0; i <= box.nx; ++i) {
+        for (int j = 0; j <= box.ny; ++j) {
+            MapCell* cell = game.game_map->at(box.at(i, j));
+            const int k = grid.index(i, j);
+            grid.halite[k] = cell->halite;
+            grid.safe[k] = safe_to_move(ship, cell->position) ? -1 : 0;
+            grid.inspired[k] = cell->inspired() ? -1 : 0;
+            grid.bonus[k] = cell->really_there ? cell->ship->halite : 0;
+        }
+    }
+    grid.ship_halite = ship->halite;
+    grid.explore = tasks[ship->id] == EXPLORE;
+    grid.turn_number = game.turn_number;
+    grid.halite_return = HALITE_RETURN;
+    return {{Direction::STILL, box.x_move, box.y_move}};
+}
 
-    // Final mine.
-    for (size_t i = 0; i < 10; ++i) {
-        WalkState ws_copy = ws;
-        ws_copy.move(Direction::STILL);
-        if (max(0.0, ws.evaluate()) >= ws_copy.evaluate()) break;
-        ws = move(ws_copy);
+// Follows a recorded walk from the ship's position while its moves are still
+// legal, then finishes it like a random walk.
+WalkState replay_walk(shared_ptr<Ship> ship, Position d,
+                      const vector<Direction>& walk, size_t length) {
+    WalkState ws(ship);
+    for (size_t i = 0; i < length && !walk_done(ship, ws, d); ++i) {
+        auto moves = walk_moves(ship, ws, d);
+        if (find(moves.begin(), moves.end(), walk[i]) == moves.end()) break;
+        ws.walk.push_back(walk[i]);
+        ws.move(walk[i]);
     }
+    continue_walk(ship, d, ws);
+
+    final_mine(ws);
 
     if (ws.walk.empty()) ws.walk.push_back(Direction::STILL);
     return ws;
 }
 
+// The best few walks found for each ship, kept across turns (--memory 1).
+// Next turn they are shifted by the executed move and re-evaluated before any
+// sampling, and then serve as prefixes for new walks.
+bool use_memory = false;
+struct WalkMemory {
+    Position position, target;
+    int turn = -1;
+    vector<pair<double, vector<Direction>>> walks;
+};
+
+unordered_map<EntityId, WalkMemory> walk_memory;
+
+const size_t WALK_ELITES = 4;
+const size_t WALK_MUTATE = 4;
+
+bool admits_walk(const WalkMemory& memory, double value) {
+    return memory.walks.size() < WALK_ELITES ||
+           value > memory.walks.back().first;
+}
+
+void remember_walk(WalkMemory& memory, double value,
+                   const vector<Direction>& walk) {
+    auto& walks = memory.walks;
+    if (!admits_walk(memory, value)) return;
+    for (auto& it : walks)
+        if (it.second == walk) return;
+
+    auto it = find_if(walks.begin(), walks.end(),
+                      [&](const pair<double, vector<Direction>>& elite) {
+                          return elite.first < value;
+                      });
+    walks.emplace(it, value, walk);
+    if (walks.size() > WALK_ELITES) walks.pop_back();
+}
+
+vector<WalkState> recall_walks(shared_ptr<Ship> ship, Position d) {
+    WalkMemory& memory = walk_memory[ship->id];
+    vector<WalkState> recalled;
+
+    auto walks = move(memory.walks);
+    memory.walks.clear();
+    if (memory.turn == game.turn_number - 1 && memory.target == d) {
+        for (auto& it : walks) {
+            vector<Direction> walk = it.second;
+            Position p =
+                game.game_map->normalize(memory.position.doff(walk[0]));
+            if (p == ship->position) {
+                walk.erase(walk.begin());
+            } else if (memory.position != ship->position) {
+                continue;
+            }
+            recalled.push_back(replay_walk(ship, d, walk, walk.size()));
+            remember_walk(memory, recalled.back().evaluate(),
+                          recalled.back().walk);
+        }
+    }
+
+    memory.position = ship->position;
+    memory.target = d;
+    memory.turn = game.turn_number;
+    return recalled;
+}
+
+// Monte Carlo tree search over walks. Each call descends the ship's tree by
+// UCB on the best walk seen below each move, expands one move and finishes
+// with a random walk. Trees are rerooted at the executed move next turn.
+struct WalkNode {
+    double visits = 0, total = 0, best = 0;
+    map<Direction, unique_ptr<WalkNode>> children;
+};
+
+struct WalkTree {
+    Position position, target;
+    int turn = -1;
+    unique_ptr<WalkNode> root;
+};
+
+unordered_map<EntityId, WalkTree> walk_trees;
+
+const double WALK_UCB = 0.5;
+const double WALK_DECAY = 0.5;
+
+void decay_tree(WalkNode* node) {
+    node->visits *= WALK_DECAY;
+    node->total *= WALK_DECAY;
+    node->best = 0;
+    for (auto& it : node->children) decay_tree(it.second.get());
+}
+
+void reroot(WalkTree& tree, shared_ptr<Ship> ship, Position d) {
+    unique_ptr<WalkNode> root;
+    if (tree.root && tree.turn == game.turn_number - 1 && tree.target == d) {
+        for (auto& it : tree.root->children) {
+            Position p = game.game_map->normalize(tree.position.doff(it.first));
+            if (p == ship->position) root = move(it.second);
+        }
+    }
+    if (root)
+        decay_tree(root.get());
+    else
+        root = make_unique<WalkNode>();
+
+    tree.position = ship->position;
+    tree.target = d;
+    tree.turn = game.turn_number;
+    tree.root = move(root);
+}
+
+WalkState tree_walk(shared_ptr<Ship> ship, Position d) {
+    WalkTree& tree = walk_trees[ship->id];
+    if (tree.turn != game.turn_number) reroot(tree, ship, d);
+
+    WalkState ws(ship);
+    vector<WalkNode*> path = {tree.root.get()};
+    while (!walk_done(ship, ws, d)) {
+        auto moves = walk_moves(ship, ws, d);
+        if (moves.empty()) break;
+
+        WalkNode* node = path.back();
+        auto untried = find_if(moves.begin(), moves.end(), [&](Direction m) {
+            return !node->children.count(m);
+        });
+        if (untried != moves.end()) {
+            node->children[*untried] = make_unique<WalkNode>();
+            path.push_back(node->children[*untried].get());
+            ws.walk.push_back(*untried);
+            ws.move(*untried);
+            continue_walk(ship, d, ws);
+            break;
+        }
+
+        const double scale = max(1.0, tree.root->best);
+        Direction next = moves.front();
+        double next_score = -1e9;
+        for (Direction m : moves) {
+            WalkNode* child = node->children[m].get();
+            double score = child->best / scale +
+                           WALK_UCB * sqrt(std::log(node->visits + 1.0) /
+                                           (child->visits + 1.0));
+            if (score > next_score) {
+                next = m;
+                next_score = score;
+            }
+        }
+        path.push_back(node->children[next].get());
+        ws.walk.push_back(next);
+        ws.move(next);
+    }
+
+    final_mine(ws);
+
+    if (ws.walk.empty()) ws.walk.push_back(Direction::STILL);
+    const double value = ws.evaluate();
+    for (WalkNode* node : path) {
+        ++node->visits;
+        node->total += value;
+        node->best = max(node->best, value);
+    }
+    return ws;
+}
+
+// Walk values by first move for one ship. With --allocate 1, walks go to the
+// ship whose best first move could most plausibly still be overtaken, using an
+// upper bound from the spread of each move's walk values, and stop once no
+// ship's could by more than a small fraction of its value. Otherwise ships
+// take turns.
+bool allocate_walks = false;
+const double WALK_MIN_SAMPLES = 16;
+const double WALK_CONFIDENCE = 2.0;
+const double WALK_TOLERANCE = 0.02;
+
+struct WalkBandit {
+    struct Arm {
+        double n = 0, mean = 0, m2 = 0, best = 0;
+    };
+    map<Direction, Arm> arms;
+    size_t arms_left = 0;
+    double n = 0;
+    double priority = -1;
+
+    void add(Direction d, double value, size_t total) {
+        if (!arms.count(d) && arms_left) --arms_left;
+        Arm& arm = arms[d];
+        ++arm.n;
+        const double delta = value - arm.mean;
+        arm.mean += delta / arm.n;
+        arm.m2 += delta * (value - arm.mean);
+        arm.best = max(arm.best, value);
+        ++n;
+
+        // Every legal first move needs a spread before it can be ruled out.
+        if (n < WALK_MIN_SAMPLES || arms_left) return;
+        auto top = max_element(arms.begin(), arms.end(),
+                               [](const pair<const Direction, Arm>& u,
+                                  const pair<const Direction, Arm>& v) {
+                                   return u.second.best < v.second.best;
+                               });
+        const double scale = max(1.0, top->second.best);
+        const double explore = std::log(max(2.0, 1.0 * total));
+        double gap = -1;
+        for (auto& it : arms) {
+            if (it.first == top->first) continue;
+            const Arm& arm = it.second;
+            if (arm.n < 2) {
+                gap = 1;
+                break;
+            }
+            const double spread = sqrt(arm.m2 / (arm.n - 1));
+            const double bound =
+                arm.best + WALK_CONFIDENCE * spread * sqrt(explore / arm.n);
+            gap = max(gap, (bound - top->second.best) / scale);
+        }
+        gap -= WALK_TOLERANCE;
+        priority = gap < 0 ? -1 : gap + sqrt(explore / n);
+    }
+};
+
+// Best first-move values for walks toward d, by dynamic programming over the
+// cells between the ship and d. A state is a cell entered at some turn with
+// cargo in some PLAN_BUCKET, and only the walk with the most halite is kept
+// per state, so the values approximate those of the best walks.
+const int PLAN_SLACK = 12;
+const Halite PLAN_BUCKET = 50;
+
+map<Direction, double> plan_walks(shared_ptr<Ship> ship, Position d) {
+    unique_ptr<GameMap>& game_map = game.game_map;
+
+    map<Direction, double> best_walks;
+
+    const WalkBox box(ship->position, d);
+    const int nx = box.nx, ny = box.ny;
+    const Direction first_moves[] = {Direction::STILL, box.x_move, box.y_move};
+
+    // Indexed by (cell, turns stayed, cargo bucket, first move).
+    struct PlanState {
+        Halite ship_halite, burned_halite;
+    };
+    const int buckets = MAX_HALITE / PLAN_BUCKET + 1;
+    auto index = [&](int i, int j, int slack, Halite h, int f) {
+        const int bucket = min(buckets - 1, max(0, h / PLAN_BUCKET));
+        return (((i * (ny + 1) + j) * (PLAN_SLACK + 1) + slack) * buckets +
+                bucket) *
+                   3 +
+               f;
+    };
+    // States reached so far, by layer (i + j). Only these need resetting for
+    // the next ship, so the work follows the walks expanded rather than the
+    // size of the box.
+    static vector<PlanState> states;
+    static vector<vector<int>> layers;
+    for (vector<int>& reached : layers) {
+        for (int s : reached) states[s] = {-1, 0};
+        reached.clear();
+    }
+    const size_t size = (nx + 1) * (ny + 1) * (PLAN_SLACK + 1) * buckets * 3;
+    if (states.size() < size) states.resize(size, {-1, 0});
+    if (layers.size() < size_t(nx + ny + 1)) layers.resize(nx + ny + 1);
+
+    auto finish = [&](WalkState ws, int f) {
+        final_mine(ws);
+        double& value = best_walks[first_moves[max(0, f)]];
+        value = max(value, ws.evaluate());
+    };
+
+    WalkState ws(ship);
+    auto expand = [&](int i, int j, int slack, int f) {
+        ws.map_halite = game_map->at(ws.p)->halite;
+        for (int k = 0;; ++k) {
+            if (walk_done(ship, ws, d)) {
+                finish(ws, k && f < 0 ? 0 : f);
+                return;
+            }
+
+            const bool stuck = ws.ship_halite < ws.map_halite / MOVE_COST_RATIO;
+            bool moved = false;
+            for (int m = 1; m <= 2 && !stuck; ++m) {
+                const int ni = i + (m == 1), nj = j + (m == 2);
+                if (ni > nx || nj > ny) continue;
+                if (!safe_to_move(ship, ws.p.doff(first_moves[m]))) continue;
+
+                WalkState next = ws;
+                next.move(first_moves[m]);
+                const int nf = f >= 0 ? f : k ? 0 : m;
+                const int s =
+                    index(ni, nj, slack + k, next.ship_halite, nf);
+                PlanState& state = states[s];
+                if (state.ship_halite < 0) layers[ni + nj].push_back(s);
+                if (state.ship_halite < 0 ||
+                    state.ship_halite - state.burned_halite <
+                        next.ship_halite - next.burned_halite) {
+                    state = {next.ship_halite, next.burned_halite};
+                }
+                moved = true;
+            }
+
+            const bool still = ws.map_halite && slack + k < PLAN_SLACK &&
+                               safe_to_move(ship, ws.p);
+            if (!still) {
+                if (!moved) finish(ws, k && f < 0 ? 0 : f);
+                return;
+            }
+            ws.move(Direction::STILL);
+        }
+    };
+
+    expand(0, 0, 0, -1);
+    for (int layer = 1; layer <= nx + ny; ++layer) {
+        // In index order, which is the order of (i, slack, bucket, move).
+        vector<int>& reached = layers[layer];
+        sort(reached.begin(), reached.end());
+        for (int s : reached) {
+            const int f = s % 3;
+            const int slack = s / 3 / buckets % (PLAN_SLACK + 1);
+            const int i = s / 3 / buckets / (PLAN_SLACK + 1) / (ny + 1);
+            const PlanState& state = states[s];
+
+            ws.p = box.at(i, layer - i);
+            ws.turns = layer + slack;
+            ws.ship_halite = state.ship_halite;
+            ws.burned_halite = state.burned_halite;
+            expand(i, layer - i, slack, f);
+        }
+    }
+
+    return best_walks;
+}
+
+// Halite a dropoff site needs within distance 5.
+const Halite IDEAL_HALITE = 7625;
+
+// Whether this turn allows planning a dropoff anywhere.
+bool dropoffs_allowed() {
+    double bases = 2.0 + game.me->dropoffs.size();
+    int bb = 7;
+    return game.turn_number <= MAX_TURNS - 50 && !started_hard_return &&
+           game.me->ships.size() / bases >= bb;
+}
+
 position_map<int> ideal_dropoff_cache;
 Halite ideal_dropoff(Position p) {
     unique_ptr<GameMap>& game_map = game.game_map;
 
+    if (!dropoffs_allowed()) return 0;
+
     int close_dropoff = game.players.size() == 2 ? 20 : 15;
 
     bool local_dropoffs = game_map->at(p)->has_structure();
@@ -257,6 +982,10 @@ Halite ideal_dropoff(Position p) {
     for (auto& it : game.me->dropoffs)
         local_dropoffs |=
             game_map->calc_dist(p, it.second->position) <= close_dropoff;
+    if (local_dropoffs) return 0;
+
+    // The cells counted below all lie in the field's square of radius 5.
+    if (field.sum(game_map->normalize(p), 1) < IDEAL_HALITE) return 0;
 
     int close_check = 5;
     Halite halite_around = 0;
@@ -305,37 +1034,164 @@ Halite ideal_dropoff(Position p) {
 
     Halite saved = halite_around;
 
-    bool ideal = saved >= 7625;
-    ideal &= !local_dropoffs;
-    ideal &= game.turn_number <= MAX_TURNS - 50;
-    ideal &= !started_hard_return;
+    bool ideal = saved >= IDEAL_HALITE;
     // ideal &= local_ships >= 3;
 
-    double bases = 2.0 + game.me->dropoffs.size();
-    int bb = 7;
-    ideal &= game.me->ships.size() / bases >= bb;
-
     return ideal * saved * sqrt(game_map->at(p)->halite);
 }
 
+Economy economy() {
+    Economy e;
+    e.turn = game.turn_number;
+    e.last_turn = MAX_TURNS;
+    e.map_halite = game.game_map->total_halite;
+    e.income = ewma;
+    e.drain = max(drain, 0.0);
+    e.trip = use_trip_stats && fleet.trip_turns.count() >= TRIP_SAMPLES
+                 ? fleet.trip_turns.quantile(0.5)
+                 : HALITE_RETURN / max(ewma, 1.0);
+    e.ships = game.me->ships.size();
+    e.enemy_ships = 0;
+    for (auto& player : game.players)
+        if (player->id != game.my_id) e.enemy_ships += player->ships.size();
+    return e;
+}
+
+// Whether a dropoff at p is projected to bank more than it costs. Trips for
+// the halite around p stop going to its current closest base.
+bool dropoff_pays(Position p) {
+    unique_ptr<GameMap>& game_map = game.game_map;
+    if (game.me->ships.empty()) return false;
+
+    double base_dist = 0;
+    int nearest = MAX_TURNS;
+    for (auto& it : game.me->ships) {
+        const Position ship = it.second->position;
+        base_dist +=
+            game_map->calc_dist(ship, game_map->at(ship)->closest_base);
+        nearest = min(nearest, game_map->calc_dist(ship, p));
+    }
+    base_dist /= game.me->ships.size();
+
+    const Economy e = economy();
+    const double mining = max(1.0, e.trip - 2 * base_dist);
+    const double far =
+        mining + 2 * game_map->calc_dist(p, game_map->at(p)->closest_base);
+    const double near = mining + HaliteField::RADII[2];
+    const double share = min(1.0, field.sum(p, 2) / e.map_halite);
+
+    EconomyBranch dropoff;
+    dropoff.dropoff_turn = game.turn_number + nearest;
+    dropoff.dropoff_cost = DROPOFF_COST - game_map->at(p)->halite;
+    dropoff.dropoff_boost = 1 + share * max(0.0, far / near - 1);
+    const double build = e.project(dropoff);
+    const double skip = e.project(EconomyBranch());
+    log::log("Economy: dropoff at", p, "build", build, "skip", skip);
+    return build > skip;
+}
+
 int main(int argc, char* argv[]) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const string flag = argv[i];
+        if (flag == "--seed") {
+            deterministic = true;
+            rng.seed(stoul(argv[i + 1]));
+        } else if (flag == "--walks") {
+            deterministic_walks = stoul(argv[i + 1]);
+        } else if (flag == "--batch") {
+            batch = stoi(argv[i + 1]);
+        } else if (flag == "--solver") {
+            auction = string(argv[i + 1]) == "auction";
+        } else if (flag == "--dump-costs") {
+            dump_costs = argv[i + 1];
+        } else if (flag == "--padding") {
+            PADDING = max(1, stoi(argv[i + 1]));
+        } else if (flag == "--reserve") {
+            reserve = stoi(argv[i + 1]);
+        } else if (flag == "--forecast") {
+            use_forecast = stoi(argv[i + 1]);
+        } else if (flag == "--profile") {
+            use_profiles = stoi(argv[i + 1]);
+        } else if (flag == "--inspire") {
+            use_inspiration = stoi(argv[i + 1]);
+        } else if (flag == "--economy") {
+            use_economy = stoi(argv[i + 1]);
+        } else if (flag == "--memory") {
+            use_memory = stoi(argv[i + 1]);
+        } else if (flag == "--allocate") {
+            allocate_walks = stoi(argv[i + 1]);
+        } else if (flag == "--trace") {
+            tracing = stoi(argv[i + 1]);
+        } else if (flag == "--trace-path") {
+            trace_path = argv[i + 1];
+        } else if (flag == "--trips") {
+            use_trip_stats = stoi(argv[i + 1]);
+        } else if (flag == "--blur") {
+            use_blur = stoi(argv[i + 1]);
+        } else if (flag == "--threads") {
+            threads = max(1, stoi(argv[i + 1]));
+        } else if (flag == "--planner") {
+            const string name = argv[i + 1];
+            if (name == "dp")
+                planner = VALUE_ITERATION;
+            else if (name == "mcts")
+                planner = TREE_SEARCH;
+            else
+                planner = RANDOM_WALK;
+        }
+    }
+
+    pool.reset(new ThreadPool(threads));
+
     game.ready("BabuBot");
+    if (tracing) {
+        if (trace_path.empty()) {
+            trace_path = "bot-" + to_string(game.my_id) + "-" +
+                         to_string(getpid()) + ".trace";
+        }
+        trace.open(trace_path, game.my_id, game.game_map->width,
+                   game.game_map->height);
+    }
 
-    HALITE_RETURN = MAX_HALITE * 0.95;
+    reservations.reset(game.game_map->width, game.game_map->height,
+                       RESERVE_TURNS + 1);
 
-    Halite total_halite = 0;
-    for (const vector<MapCell>& cells : game.game_map->cells)
-        for (const MapCell& cell : cells) total_halite += cell.halite;
+    HALITE_RETURN = MAX_HALITE * 0.95;
+    mining::populate_tables();
 
     unordered_map<EntityId, Halite> last_halite;
 
     Halite wanted = 0;
 
+    // Distances from every row and column to our ships, and the candidate
+    // dropoff sites, for picking a future dropoff.
+    AxisDistances ship_xs, ship_ys;
+    SiteIndex sites(IDEAL_HALITE);
+
+    TargetTable targets;
+
     for (;;) {
         game.update_frame();
+        field.update(*game.game_map);
+        sites.update(*game.game_map, field);
+        forecast.update(game);
+        inspiration.update(forecast, game.game_map->width,
+                           game.game_map->height);
+        profiler.update(game);
+        fleet.update(game);
+        for (auto& player : game.players) {
+            if (player->id == game.my_id) continue;
+            const OpponentProfile& profile = profiler[player->id];
+            log::log("Profile", player->id, "ram", profile.ram.rate(), "dodge",
+                     profile.dodge.rate(), "inspired",
+                     profile.inspired.rate(), "early",
+                     profile.early_return.rate());
+        }
         shared_ptr<Player> me = game.me;
         unique_ptr<GameMap>& game_map = game.game_map;
         auto begin = steady_clock::now();
+        turn_allocations = alloc::Counts();
+        log_allocations("frame");
 
         safe_to_move_cache.clear();
         ideal_dropoff_cache.clear();
@@ -373,34 +1229,49 @@ int main(int argc, char* argv[]) {
                 me->ships.erase(ship->id);
             } else {
                 me->dropoffs[future_dropoff->id] = future_dropoff;
-                message(future_dropoff->position, "blue");
+                message(future_dropoff->position, TRACE_BLUE);
             }
         }
 
         auto end = steady_clock::now();
         log::log("Millis: ", duration_cast<milliseconds>(end - begin).count());
+        log_allocations("dropoffs");
 
         log::log("Inspiration. Closest base.");
-        position_map<int> close_enemies, close_allies;
+        for (const pair<Position, bool>& counted : counted_ships) {
+            count_close_ship(counted.first, counted.second, -1);
+            game_map->at(counted.first)->really_there = false;
+        }
+        counted_ships.clear();
         for (auto& player : game.players) {
-            const int IR = INSPIRATION_RADIUS;
             for (auto& it : player->ships) {
-                Position p = it.second->position;
-                for (int dx = -IR; dx <= IR; ++dx) {
-                    for (int dy = -IR; dy <= IR; ++dy) {
-                        if (abs(dx) + abs(dy) > IR) continue;
-                        if (player->id == me->id)
-                            ++close_allies[game_map->normalize(
-                                Position(p.x + dx, p.y + dy))];
-                        else
-                            ++close_enemies[game_map->normalize(
-                                Position(p.x + dx, p.y + dy))];
+                const bool ally = player->id == me->id;
+                count_close_ship(it.second->position, ally, 1);
+                counted_ships.emplace_back(it.second->position, ally);
+            }
+        }
+
+        vector<Position> base_positions = {me->shipyard->position};
+        for (auto& it : me->dropoffs)
+            base_positions.push_back(it.second->position);
+        if (base_positions != closest_base_bases) {
+            closest_base_bases = base_positions;
+            for (vector<MapCell>& cell_row : game_map->cells) {
+                for (MapCell& cell : cell_row) {
+                    Position p = cell.position;
+                    cell.closest_base = me->shipyard->position;
+                    for (auto& it : me->dropoffs) {
+                        if (game_map->calc_dist(p, it.second->position) <
+                            game_map->calc_dist(p, cell.closest_base)) {
+                            cell.closest_base = it.second->position;
+                        }
                     }
                 }
             }
         }
 
-        multiset<Position> targets;
+        // Every cell is a target once; recent collisions get two more.
+        targets.reset(game_map->width, game_map->height, 1);
         for (Position p : future_collisions) {
             recent_collisions[p] = game.turn_number;
             log::log("Collision at", p);
@@ -417,29 +1288,8 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        Halite current_halite = 0;
-        bool all_empty = true;
-        for (vector<MapCell>& cell_row : game_map->cells) {
-            for (MapCell& cell : cell_row) {
-                Position p = cell.position;
-
-                cell.really_there = false;
-                cell.close_enemies = close_enemies[p];
-                cell.close_allies = close_allies[p];
-                cell.close_ships.clear();
-                cell.closest_base = me->shipyard->position;
-                for (auto& it : me->dropoffs) {
-                    if (game_map->calc_dist(p, it.second->position) <
-                        game_map->calc_dist(p, cell.closest_base)) {
-                        cell.closest_base = it.second->position;
-                    }
-                }
-
-                current_halite += cell.halite;
-                all_empty &= !cell.halite;
-                targets.insert(p);
-            }
-        }
+        const Halite current_halite = game_map->total_halite;
+        const bool all_empty = !game_map->halite_cells;
 
         average_halite_left = current_halite * 1.0 / total_ships;
 
@@ -457,18 +1307,6 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        for (auto& it : me->ships) {
-            MapCell* cell = game_map->at(it.second);
-            auto moves = game_map->get_moves(cell->position, cell->closest_base,
-                                             it.second->halite, 0);
-            if (moves.empty()) continue;
-
-            Direction od = moves.front();
-            for (Direction d : moves)
-                if (cell->close_ships[d] < cell->close_ships[od]) od = d;
-            ++cell->close_ships[od];
-        }
-
         for (auto& player : game.players) {
             if (player->id == me->id) continue;
             for (auto& it : player->ships) {
@@ -485,31 +1323,31 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        // Hard return.
-        for (auto& it : me->ships) {
-            shared_ptr<Ship> ship = it.second;
-            const EntityId id = ship->id;
-
-            MapCell* cell = game_map->at(ship);
-
-            if (!tasks.count(id)) continue;
-
-            double return_turn =
-                game_map->calc_dist(ship->position, cell->closest_base);
-
-            auto moves = game_map->get_moves(cell->position, cell->closest_base,
-                                             it.second->halite, 0);
-            if (moves.empty()) continue;
-
-            Direction od = moves.front();
-            for (Direction d : moves)
-                if (cell->close_ships[d] < cell->close_ships[od]) od = d;
-            return_turn = max(return_turn, 1.0 * cell->close_ships[od]);
+        // Hard return, once a ship has to leave for everyone to get into a
+        // base by the last turn, four ships per base per turn.
+        {
+            vector<shared_ptr<Ship>> ships;
+            vector<ReturnRequest> requests;
+            position_map<int> bases;
+            for (auto& it : me->ships) {
+                shared_ptr<Ship> ship = it.second;
+                MapCell* cell = game_map->at(ship);
+                const int dist =
+                    game_map->calc_dist(ship->position, cell->closest_base);
+                if (!tasks.count(ship->id) || !dist) continue;
+
+                bases.emplace(cell->closest_base, bases.size());
+                ships.push_back(ship);
+                requests.push_back({bases[cell->closest_base], dist});
+            }
 
-            return_turn += game.turn_number;
-            if (all_empty || return_turn > MAX_TURNS) {
-                tasks[id] = HARD_RETURN;
-                started_hard_return = true;
+            vector<int> departures =
+                latest_departures(requests, MAX_TURNS, ALL_CARDINALS.size());
+            for (size_t i = 0; i < ships.size(); ++i) {
+                if (all_empty || game.turn_number >= departures[i]) {
+                    tasks[ships[i]->id] = HARD_RETURN;
+                    started_hard_return = true;
+                }
             }
         }
 
@@ -599,8 +1437,41 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        if (reserve) {
+            log::log("Return plans.");
+            vector<EntityId> stale;
+            for (auto& it : return_plans) {
+                if (!me->ships.count(it.first) || tasks[it.first] != RETURN)
+                    stale.push_back(it.first);
+            }
+            for (EntityId id : stale) release_plan(id);
+            stale.clear();
+            for (auto& it : return_plans)
+                if (!on_plan(me->ships[it.first])) stale.push_back(it.first);
+            for (EntityId id : stale) release_plan(id);
+
+            vector<shared_ptr<Ship>> unplanned;
+            for (auto ship : returners) {
+                if (tasks[ship->id] == RETURN && !return_plans.count(ship->id))
+                    unplanned.push_back(ship);
+            }
+            sort(unplanned.begin(), unplanned.end(),
+                 [&](shared_ptr<Ship> u, shared_ptr<Ship> v) {
+                     return make_pair(
+                                game_map->calc_dist(u->position, u->next),
+                                u->id) <
+                            make_pair(
+                                game_map->calc_dist(v->position, v->next),
+                                v->id);
+                 });
+            size_t planned = 0;
+            for (auto ship : unplanned) planned += plan_return(ship);
+            log::log("Planned", planned, "of", unplanned.size(), "returns.");
+        }
+
         end = steady_clock::now();
         log::log("Millis: ", duration_cast<milliseconds>(end - begin).count());
+        log_allocations("tasks");
 
         log::log("Explorer cost matrix.");
         {
@@ -610,87 +1481,145 @@ int main(int argc, char* argv[]) {
             vector<double> top_score;
             top_score.reserve(explorers.size());
 
-            for (auto it = explorers.begin(); it != explorers.end();) {
-                auto ship = *it;
+            ExploreTargets explore_targets;
+            explore_targets.width = game_map->width;
+            explore_targets.height = game_map->height;
+            explore_targets.resize(targets.size());
+            vector<size_t> occupied_targets;
+            const vector<int32_t>& target_cells = targets.slots();
+            for (size_t k = 0; k < target_cells.size(); ++k) {
+                const Position p = targets.position(target_cells[k]);
+                MapCell* cell = game_map->at(p);
 
-                position_map<Halite> dist;
-                bfs(dist, ship);
-                priority_queue<double> pq;
-
-                vector<double> uncompressed_cost;
-                uncompressed_cost.reserve(targets.size());
-                for (Position p : targets) {
-                    MapCell* cell = game_map->at(p);
-
-                    double d = game_map->calc_dist(ship->position, p);
-                    double dd = game_map->calc_dist(p, cell->closest_base);
-
-                    if (!dist.count(p)) dist[p] = 1e3;
-                    Halite profit = cell->halite - dist[p];
-
-                    const int IBS = INSPIRED_BONUS_MULTIPLIER;
-
-                    bool future_inspire =
-                        future_dropoff &&
-                        game_map->calc_dist(future_dropoff->position, p) <= 3 &&
-                        (!fresh_dropoffs.count(
-                             game_map->at(ship)->closest_base) ||
-                         game_map->at(ship)->closest_base ==
-                             future_dropoff->position);
-
-                    if (cell->inspired() || future_inspire)
-                        profit += IBS * cell->halite;
-
-                    if (cell->ship && cell->ship->owner != game.my_id &&
-                        cell->really_there &&
-                        (game.players.size() == 2 ||
-                         cell->halite > 3 * average_halite_left)) {
-                        Halite collision_halite = cell->ship->halite;
-                        if (cell->inspired() || future_inspire)
-                            collision_halite += IBS * collision_halite;
-                        if (profit + ship->halite < collision_halite)
-                            profit += collision_halite;
-                    }
+                explore_targets.x[k] = p.x;
+                explore_targets.y[k] = p.y;
+                explore_targets.cell[k] = target_cells[k];
+                explore_targets.halite[k] = cell->halite;
+                explore_targets.base_dist[k] =
+                    game_map->calc_dist(p, cell->closest_base);
+                explore_targets.inspired[0][k] = cell->inspired() ? -1 : 0;
+                for (int a = 1; a < INSPIRE_ARRIVALS; ++a) {
+                    const bool inspired =
+                        use_inspiration
+                            ? inspiration.inspired(
+                                  p, min(a, InspirationForecast::HORIZON))
+                            : cell->inspired();
+                    explore_targets.inspired[a][k] = inspired ? -1 : 0;
+                }
+                explore_targets.future_inspired[k] =
+                    future_dropoff &&
+                            game_map->calc_dist(future_dropoff->position,
+                                                p) <= 3
+                        ? -1
+                        : 0;
+
+                explore_targets.enemy_halite[k] = -1;
+                if (cell->ship && cell->ship->owner != game.my_id &&
+                    cell->really_there &&
+                    (game.players.size() == 2 ||
+                     cell->halite > 3 * average_halite_left)) {
+                    explore_targets.enemy_halite[k] = cell->ship->halite;
+                }
+                explore_targets.neighbourhood[k] =
+                    use_blur ? NEIGHBOURHOOD_SHARE * field.blurred(p) : 0;
+                if (cell->is_occupied()) occupied_targets.push_back(k);
+            }
 
-                    profit = min(profit, MAX_HALITE - ship->halite);
+            // The rows below are built on the pool, where safe_to_move()
+            // only reads its cache, so fill it first. Return planning has
+            // already filled it with returners' cargo, which must not
+            // decide where explorers may go.
+            safe_to_move_cache.clear();
+            if (!explorers.empty()) fill_safe_to_move_cache(explorers.front());
+
+            struct ExplorerRow {
+                vector<double> cost;
+                double top_score;
+                bool skip;
+            };
+            vector<ExplorerRow> rows(explorers.size());
+            vector<vector<int32_t>> dists(pool->size());
+            vector<vector<float>> rates(pool->size());
+            vector<vector<double>> top_costs(pool->size());
+            vector<vector<char>> top_targets(
+                pool->size(), vector<char>(targets.size()));
+
+            safe_to_move_read_only = true;
+            pool->parallel_for(explorers.size(), [&](size_t i,
+                                                     unsigned thread) {
+                auto ship = explorers[i];
+                vector<int32_t>& dist = dists[thread];
+                vector<float>& rate = rates[thread];
+                vector<double>& top_cost = top_costs[thread];
+                ExplorerRow& row = rows[i];
 
-                    if (!safe_to_move(ship, p)) profit = 0;
-                    double rate = profit / (1.0 + d + dd);
+                bfs(dist, ship);
 
-                    uncompressed_cost.push_back(-rate + 5e3);
-                    if (rate > 0) pq.push(uncompressed_cost.back());
-                    while (pq.size() > PADDING) pq.pop();
+                const Position base = game_map->at(ship)->closest_base;
+                const bool future_inspire =
+                    future_dropoff && (!fresh_dropoffs.count(base) ||
+                                       base == future_dropoff->position);
+                explore_rates(explore_targets, ship->position.x,
+                              ship->position.y, ship->halite, future_inspire,
+                              dist, rate);
+                for (size_t k : occupied_targets) {
+                    Position p(explore_targets.x[k], explore_targets.y[k]);
+                    if (!safe_to_move(ship, p)) rate[k] = 0;
                 }
 
-                if (pq.empty()) {
-                    log::log("Skipping exploration for", ship->id);
-                    tasks[ship->id] = RETURN;
-                    ship->next = game_map->at(ship)->closest_base;
-                    returners.push_back(ship);
-                    it = explorers.erase(it);
-                    continue;
+                row.cost.resize(targets.size());
+                top_cost.clear();
+                for (size_t k = 0; k < rate.size(); ++k) {
+                    row.cost[k] = -rate[k] + 5e3;
+                    if (rate[k] > 0) top_cost.push_back(row.cost[k]);
                 }
 
-                for (size_t i = 0; i < uncompressed_cost.size(); ++i) {
-                    if (!is_top_target[i] && uncompressed_cost[i] <= pq.top())
-                        is_top_target[i] = true;
-                }
-                top_score.push_back(pq.top());
-                uncompressed_cost_matrix.push_back(move(uncompressed_cost));
+                row.skip = top_cost.empty();
+                if (row.skip) return;
+
+                // The PADDING cheapest profitable targets.
+                auto kth = top_cost.begin() +
+                           (min(PADDING, top_cost.size()) - 1);
+                nth_element(top_cost.begin(), kth, top_cost.end());
+                row.top_score = *kth;
+                for (size_t k = 0; k < row.cost.size(); ++k)
+                    top_targets[thread][k] |= row.cost[k] <= *kth;
+            });
+            safe_to_move_read_only = false;
+
+            for (size_t i = 0; i < is_top_target.size(); ++i) {
+                for (const vector<char>& top : top_targets)
+                    if (top[i]) is_top_target[i] = true;
+            }
 
-                ++it;
+            {
+                size_t i = 0;
+                for (auto it = explorers.begin(); it != explorers.end();
+                     ++i) {
+                    auto ship = *it;
+                    if (rows[i].skip) {
+                        log::log("Skipping exploration for", ship->id);
+                        tasks[ship->id] = RETURN;
+                        ship->next = game_map->at(ship)->closest_base;
+                        returners.push_back(ship);
+                        it = explorers.erase(it);
+                        continue;
+                    }
+
+                    top_score.push_back(rows[i].top_score);
+                    uncompressed_cost_matrix.push_back(move(rows[i].cost));
+                    ++it;
+                }
             }
 
             if (!explorers.empty()) {
                 // Coordinate compress.
                 vector<Position> target_space;
-                {
-                    auto it = targets.begin();
-                    for (size_t i = 0; i < targets.size(); ++i, ++it) {
-                        if (is_top_target[i]) {
-                            target_space.push_back(*it);
-                            // message(*it, "blue");
-                        }
+                for (size_t i = 0; i < target_cells.size(); ++i) {
+                    if (is_top_target[i]) {
+                        target_space.push_back(
+                            targets.position(target_cells[i]));
+                        // message(target_space.back(), TRACE_BLUE);
                     }
                 }
 
@@ -717,9 +1646,15 @@ int main(int argc, char* argv[]) {
                 log::log("Millis: ",
                          duration_cast<milliseconds>(end - begin).count());
 
+                if (!dump_costs.empty()) dump_cost_matrix(cost_matrix);
                 vector<int> assignment(explorers.size());
-                HungarianAlgorithm ha;
-                ha.Solve(cost_matrix, assignment);
+                if (auction) {
+                    AuctionAlgorithm aa(pool.get());
+                    aa.Solve(cost_matrix, assignment);
+                } else {
+                    HungarianAlgorithm ha;
+                    ha.Solve(cost_matrix, assignment);
+                }
 
                 end = steady_clock::now();
                 log::log("Millis: ",
@@ -734,6 +1669,7 @@ int main(int argc, char* argv[]) {
             log::log("Millis: ",
                      duration_cast<milliseconds>(end - begin).count());
         }
+        log_allocations("explorers");
 
         log::log("Move cost matrix.");
         if (!explorers.empty() || !returners.empty()) {
@@ -765,35 +1701,137 @@ int main(int argc, char* argv[]) {
             }
 
             // Random walk to generate costs.
-            vector<unordered_map<Direction, double>> best_walks(
-                explorers.size());
-            bool timeout = false;
-            int timeout_walks = 0;
+            vector<map<Direction, double>> best_walks(explorers.size());
+            bool timeout = planner == VALUE_ITERATION;
+            size_t timeout_walks = 0;
             end = steady_clock::now();
+            for (auto it = walk_trees.begin(); it != walk_trees.end();) {
+                if (me->ships.count(it->first))
+                    ++it;
+                else
+                    it = walk_trees.erase(it);
+            }
+            for (auto it = walk_memory.begin(); it != walk_memory.end();) {
+                if (me->ships.count(it->first))
+                    ++it;
+                else
+                    it = walk_memory.erase(it);
+            }
+            vector<WalkBandit> bandits(explorers.size());
+            vector<WalkGrid> grids(explorers.size());
+            vector<array<Direction, 3>> grid_moves(explorers.size());
+            for (size_t i = 0; i < explorers.size(); ++i) {
+                shared_ptr<Ship> ship = explorers[i];
+                if (planner == VALUE_ITERATION || ship->position == ship->next)
+                    continue;
+
+                auto moves = walk_moves(ship, WalkState(ship), ship->next);
+                bandits[i].arms_left = moves.size();
+
+                // Batches cannot step sideways, so ships that must start
+                // that way are walked one at a time.
+                if (batch && planner == RANDOM_WALK && !moves.empty()) {
+                    grid_moves[i] = fill_walk_grid(grids[i], ship, ship->next);
+                    for (Direction d : moves) {
+                        if (find(grid_moves[i].begin(), grid_moves[i].end(),
+                                 d) == grid_moves[i].end()) {
+                            grids[i].resize(-1, -1);
+                        }
+                    }
+                }
+                bandits[i].priority = 1e9;
+                if (!use_memory) continue;
+                for (auto& ws : recall_walks(ship, ship->next)) {
+                    best_walks[i][ws.walk.front()] =
+                        max(best_walks[i][ws.walk.front()], ws.evaluate());
+                    bandits[i].add(ws.walk.front(), ws.evaluate(), 1);
+                }
+            }
+            if (planner == VALUE_ITERATION) {
+                for (size_t i = 0; i < explorers.size(); ++i) {
+                    best_walks[i] =
+                        plan_walks(explorers[i], explorers[i]->next);
+                }
+                log::log("Planned", explorers.size(), "walks in",
+                         duration_cast<microseconds>(steady_clock::now() - end)
+                             .count(),
+                         "us.");
+            }
+            size_t turn_taker = 0;
             while (!timeout) {
-                for (size_t i = 0; i < explorers.size() && !timeout; ++i) {
-                    if (duration_cast<milliseconds>(steady_clock::now() - end)
-                            .count() > 1000) {
-                        log::log("Was able to do", timeout_walks,
+                size_t i = 0;
+                if (!allocate_walks) {
+                    if (explorers.empty()) break;
+                    i = turn_taker++ % explorers.size();
+                } else {
+                    for (size_t j = 1; j < bandits.size(); ++j)
+                        if (bandits[j].priority > bandits[i].priority) i = j;
+                    if (bandits.empty() || bandits[i].priority < 0) {
+                        log::log("Walks converged after", timeout_walks,
                                  "random walks.");
-                        timeout = true;
+                        break;
                     }
-                    if (duration_cast<milliseconds>(steady_clock::now() - begin)
+                }
+
+                if (deterministic) {
+                    timeout = timeout_walks >= deterministic_walks;
+                } else if (duration_cast<milliseconds>(steady_clock::now() -
+                                                       end)
+                               .count() > 1000) {
+                    log::log("Was able to do", timeout_walks, "random walks.");
+                    timeout = true;
+                }
+                if (!deterministic &&
+                    duration_cast<milliseconds>(steady_clock::now() - begin)
                             .count() > 1500) {
-                        timeout = true;
+                    timeout = true;
+                }
+                ++timeout_walks;
+
+                shared_ptr<Ship> ship = explorers[i];
+                WalkMemory& memory = walk_memory[ship->id];
+                WalkState ws(ship);
+                if (planner == TREE_SEARCH) {
+                    ws = tree_walk(ship, ship->next);
+                } else if (use_memory && !memory.walks.empty() &&
+                           rng() % WALK_MUTATE == 0) {
+                    auto& walk =
+                        memory.walks[rng() % memory.walks.size()].second;
+                    ws = replay_walk(ship, ship->next, walk,
+                                     rng() % walk.size());
+                } else if (grids[i].nx >= 0) {
+                    array<BatchWalk, WALK_BATCH> walks;
+                    batch_walks(grids[i], rng(), walks);
+                    for (BatchWalk& walk : walks) {
+                        const Direction front =
+                            grid_moves[i][walk.length ? walk.moves[0] : 0];
+                        best_walks[i][front] =
+                            max(best_walks[i][front], walk.value);
+                        bandits[i].add(front, walk.value, timeout_walks);
+                        if (!use_memory || !admits_walk(memory, walk.value))
+                            continue;
+
+                        vector<Direction> moves(1, Direction::STILL);
+                        if (walk.length) moves.resize(walk.length);
+                        for (int k = 0; k < walk.length; ++k)
+                            moves[k] = grid_moves[i][walk.moves[k]];
+                        remember_walk(memory, walk.value, moves);
                     }
-                    ++timeout_walks;
-
-                    auto ws = random_walk(explorers[i], explorers[i]->next);
-                    best_walks[i][ws.walk.front()] =
-                        max(best_walks[i][ws.walk.front()], ws.evaluate());
+                    timeout_walks += WALK_BATCH - 1;
+                    continue;
+                } else {
+                    ws = random_walk(ship, ship->next);
                 }
+                best_walks[i][ws.walk.front()] =
+                    max(best_walks[i][ws.walk.front()], ws.evaluate());
+                bandits[i].add(ws.walk.front(), ws.evaluate(), timeout_walks);
+                if (use_memory) remember_walk(memory, ws.evaluate(), ws.walk);
             }
 
             for (size_t i = 0; i < explorers.size(); ++i) {
                 Position p = explorers[i]->position;
 
-                position_map<double> surrounding_cost;
+                map<Position, double> surrounding_cost;
 
                 // Default values.
                 for (Position pp : p.get_surrounding_cardinals())
@@ -809,15 +1847,25 @@ int main(int argc, char* argv[]) {
                         surrounding_cost[pp] = pow(1e3, 1.0 - it.second / best);
                     }
 
+                    // A reserved return path beats any walk.
+                    if (return_plans.count(explorers[i]->id))
+                        surrounding_cost[planned_move(explorers[i])] = 0.5;
+
                     if (last_moved[explorers[i]->id] <= game.turn_number - 5)
                         surrounding_cost[p] = 1e7;
                 }
 
                 bool print = false;
                 for (auto& it : surrounding_cost) {
-                    if (safe_to_move(explorers[i], it.first)) {
+                    const bool safe = safe_to_move(explorers[i], it.first);
+                    const TraceVerdict verdict =
+                        safe ? TRACE_SAFE
+                             : game_map->at(it.first)->ship->owner != me->id
+                                   ? TRACE_ENEMY
+                                   : TRACE_OWN_SHIP;
+                    if (safe) {
                         cost_matrix[i][move_indices[it.first]] = it.second;
-                    } else if (game_map->at(it.first)->ship->owner != me->id) {
+                    } else if (verdict == TRACE_ENEMY) {
                         // safe_to_move(explorers[i], it.first, true);
                         // print = true;
 
@@ -834,14 +1882,20 @@ int main(int argc, char* argv[]) {
                                 cost_matrix[i][move_indices[it.first]] = 1e7;
                             }
                         } else {
+                            const PlayerId owner =
+                                game_map->at(it.first)->ship->owner;
                             if (enemy_halite <
-                                explorers[i]->halite + MAX_HALITE * 0.25) {
+                                explorers[i]->halite +
+                                    ram_margin(owner, MAX_HALITE * 0.25)) {
                                 cost_matrix[i][move_indices[it.first]] = 1e7;
                             } else {
                                 cost_matrix[i][move_indices[it.first]] = 1e6;
                             }
                         }
                     }
+                    trace.write(game.turn_number, TRACE_OPTION, verdict,
+                                explorers[i]->id, it.first, {-1, -1},
+                                cost_matrix[i][move_indices[it.first]]);
                 }
                 if (print) {
                     log::log("Ship", explorers[i]->id);
@@ -853,12 +1907,87 @@ int main(int argc, char* argv[]) {
                 }
             }
 
+            // Ships only compete for the cells next to them, so the
+            // assignment splits into one independent problem per group of
+            // ships whose neighbourhoods overlap.
+            vector<int> group(explorers.size());
+            iota(group.begin(), group.end(), 0);
+            function<int(int)> find_group = [&](int i) {
+                return group[i] == i ? i : group[i] = find_group(group[i]);
+            };
+            vector<int> first_ship(move_space.size(), -1);
+            for (size_t i = 0; i < explorers.size(); ++i) {
+                Position p = explorers[i]->position;
+                array<Position, 5> cells = {{p}};
+                for (size_t k = 0; k < 4; ++k) {
+                    cells[k + 1] =
+                        game_map->normalize(p.get_surrounding_cardinals()[k]);
+                }
+                for (Position pp : cells) {
+                    int& first = first_ship[move_indices[pp]];
+                    if (first < 0)
+                        first = i;
+                    else
+                        group[find_group(i)] = find_group(first);
+                }
+            }
+
+            struct MoveGroup {
+                vector<int> ships, cells;
+            };
+            vector<MoveGroup> move_groups;
+            {
+                vector<int> group_index(explorers.size(), -1);
+                for (size_t i = 0; i < explorers.size(); ++i) {
+                    int& k = group_index[find_group(i)];
+                    if (k < 0) {
+                        k = move_groups.size();
+                        move_groups.emplace_back();
+                    }
+                    move_groups[k].ships.push_back(i);
+                }
+                for (size_t j = 0; j < move_space.size(); ++j) {
+                    int k = group_index[find_group(first_ship[j])];
+                    move_groups[k].cells.push_back(j);
+                }
+            }
+            log::log("Move groups:", move_groups.size());
+
             // Solve and execute moves.
             vector<int> assignment(explorers.size());
-            HungarianAlgorithm ha;
-            ha.Solve(cost_matrix, assignment);
+            auto solve_group = [&](size_t k, unsigned) {
+                const MoveGroup& move_group = move_groups[k];
+                vector<vector<double>> cost;
+                cost.reserve(move_group.ships.size());
+                for (int i : move_group.ships) {
+                    vector<double> row;
+                    row.reserve(move_group.cells.size());
+                    for (int j : move_group.cells)
+                        row.push_back(cost_matrix[i][j]);
+                    cost.push_back(move(row));
+                }
+
+                vector<int> group_assignment(move_group.ships.size());
+                HungarianAlgorithm ha;
+                ha.Solve(cost, group_assignment);
+                for (size_t i = 0; i < move_group.ships.size(); ++i) {
+                    assignment[move_group.ships[i]] =
+                        move_group.cells[group_assignment[i]];
+                }
+            };
+            if (explorers.size() >= PARALLEL_MOVE_SHIPS) {
+                pool->parallel_for(move_groups.size(), solve_group);
+            } else {
+                for (size_t k = 0; k < move_groups.size(); ++k)
+                    solve_group(k, 0);
+            }
 
             for (size_t i = 0; i < assignment.size(); ++i) {
+                trace.write(game.turn_number, TRACE_SHIP,
+                            tasks[explorers[i]->id], explorers[i]->id,
+                            explorers[i]->position, explorers[i]->next);
+                trace.write(game.turn_number, TRACE_MOVE, 0, explorers[i]->id,
+                            move_space[assignment[i]]);
                 if (explorers[i]->position == move_space[assignment[i]]) {
                     game_map->at(explorers[i])->ship = explorers[i];
                     command_queue.push_back(explorers[i]->stay_still());
@@ -879,24 +2008,43 @@ int main(int argc, char* argv[]) {
         }
 
         vector<pair<Position, double>> futures;
-        for (Position p : targets) {
-            Halite ideal = ideal_dropoff(p);
-            if (!ideal) continue;
-
-            double d = 1;
-            for (auto it : me->ships)
-                d += game_map->calc_dist(p, it.second->position);
-            d /= me->ships.size();
-
-            futures.emplace_back(p, ideal / d);
-        }
-        sort(futures.begin(), futures.end(),
-             [&](pair<Position, double> u, pair<Position, double> v) {
-                 return u.second > v.second;
-             });
-        if (!futures.empty() && !future_dropoff) {
+        if (!future_dropoff && dropoffs_allowed()) {
+            vector<int> xs, ys;
+            for (auto& it : me->ships) {
+                xs.push_back(it.second->position.x);
+                ys.push_back(it.second->position.y);
+            }
+            ship_xs.update(xs, game_map->width);
+            ship_ys.update(ys, game_map->height);
+            auto ship_dist = [&](Position p) {
+                return (1.0 + ship_xs.at(p.x) + ship_ys.at(p.y)) /
+                       me->ships.size();
+            };
+            const double closest =
+                (1.0 + ship_xs.min() + ship_ys.min()) / me->ships.size();
+
+            // Sites keep their bounds across turns; a site fills as many of
+            // the three places as it has copies among the targets.
+            for (auto& site : sites.best(
+                     3, closest,
+                     [&](int32_t cell) {
+                         return ship_dist(targets.position(cell));
+                     },
+                     [&](int32_t cell) {
+                         return targets.count(targets.position(cell));
+                     },
+                     [&](int32_t cell) {
+                         const Position p = targets.position(cell);
+                         return ideal_dropoff(p) / ship_dist(p);
+                     })) {
+                futures.emplace_back(targets.position(site.first),
+                                     site.second);
+            }
+        }
+        if (!futures.empty()) {
             futures.resize(3);
             for (auto future : futures) {
+                if (use_economy && !dropoff_pays(future.first)) continue;
                 wanted = DROPOFF_COST - game_map->at(future.first)->halite;
 
                 Halite fluff = 0, forced_fluff = 0;
@@ -932,7 +2080,7 @@ int main(int argc, char* argv[]) {
                 }
 
                 if (wanted - fluff <= me->halite) {
-                    // message(futures.front().first, "green");
+                    // message(futures.front().first, TRACE_GREEN);
                     future_dropoff = make_shared<Dropoff>(
                         game.my_id, -2, future.first.x, future.first.y);
                     break;
@@ -942,6 +2090,7 @@ int main(int argc, char* argv[]) {
 
         end = steady_clock::now();
         log::log("Millis: ", duration_cast<milliseconds>(end - begin).count());
+        log_allocations("moves");
 
         if (game.turn_number % 5 == 0) {
             Halite h = 0;
@@ -950,11 +2099,40 @@ int main(int argc, char* argv[]) {
                     h += ship->halite - last_halite[ship->id];
                 last_halite[ship->id] = ship->halite;
             }
+            for (auto it = last_halite.begin(); it != last_halite.end();) {
+                if (me->ships.count(it->first))
+                    ++it;
+                else
+                    it = last_halite.erase(it);
+            }
             ewma = ALPHA * h / (me->ships.size() * 5) + (1 - ALPHA) * ewma;
             should_spawn_ewma =
                 game.turn_number + 2 * SHIP_COST / ewma < MAX_TURNS;
 
             log::log("EWMA:", ewma, "Should spawn ships:", should_spawn_ewma);
+
+            if (drain_halite >= 0 && total_ships) {
+                const double sample =
+                    max(0, drain_halite - game_map->total_halite) /
+                    (total_ships * 5.0);
+                drain = drain < 0 ? sample
+                                  : ALPHA * sample + (1 - ALPHA) * drain;
+            }
+            drain_halite = game_map->total_halite;
+        }
+
+        bool should_spawn_economy = false;
+        if (use_economy) {
+            const Economy e = economy();
+            EconomyBranch now, later;
+            now.spawn_turn = game.turn_number;
+            later.spawn_turn = game.turn_number + SPAWN_LATER;
+            const double spawn_now = e.project(now);
+            const double spawn_later = e.project(later);
+            const double never = e.project(EconomyBranch());
+            should_spawn_economy = spawn_now > max(spawn_later, never);
+            log::log("Economy: now", spawn_now, "later", spawn_later,
+                     "never", never, "trip", e.trip);
         }
 
         log::log("Spawn ships.");
@@ -971,7 +2149,9 @@ int main(int argc, char* argv[]) {
         bool should_spawn = !game_map->at(me->shipyard)->is_occupied();
         should_spawn &= !started_hard_return;
         should_spawn &= 2 * average_halite_left > SHIP_COST;
-        should_spawn &= should_spawn_ewma || me->ships.size() < ship_lo;
+        should_spawn &= (use_economy ? should_spawn_economy
+                                     : should_spawn_ewma) ||
+                        me->ships.size() < ship_lo;
         should_spawn &= me->ships.size() < ship_hi + 5;
         should_spawn &= game.turn_number <= MAX_TURNS - 50;
 
@@ -999,16 +2179,20 @@ int main(int argc, char* argv[]) {
             log::log("Spawning ship!");
         }
 
-        if (game.turn_number == MAX_TURNS && game.my_id == 0) {
+        if (game.turn_number == MAX_TURNS) {
             log::log("Done!");
-            ofstream fout;
-            fout.open("replays/__flog.json");
-            fout << "[\n" << flog.str();
-            fout.close();
+            fleet.dump();
         }
+        trace.flush();
 
         end = steady_clock::now();
         log::log("Millis: ", duration_cast<milliseconds>(end - begin).count());
+        log_allocations("spawns");
+        if (alloc::enabled()) {
+            log::log("Allocations: turn", turn_allocations.allocations, "new",
+                     turn_allocations.frees, "delete", turn_allocations.bytes,
+                     "bytes", turn_allocations.peak, "peak");
+        }
 
         if (!game.end_turn(command_queue)) break;
     }
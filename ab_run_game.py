@@ -0,0 +1,171 @@
+import argparse
+import json
+import math
+import os
+import signal
+import subprocess
+import sys
+import threading
+from concurrent.futures import ThreadPoolExecutor, as_completed
+from random import randint
+
+# Compares two builds of the bot by playing both against the same opponents on
+# the same seeds, and stops with a sequential probability ratio test as soon as
+# one build is significantly better or an improvement of --delta is ruled out.
+#
+# python3 ab_run_game.py ./MyBot ./bots/MyBotOld
+
+parser = argparse.ArgumentParser()
+parser.add_argument('candidate')
+parser.add_argument('baseline')
+parser.add_argument('--opponent', default='./bots/Jan20')
+parser.add_argument('--players', type=int, default=4, choices=[2, 4])
+parser.add_argument('--sizes', default='32,40,48,56,64')
+parser.add_argument('--jobs', type=int, default=os.cpu_count())
+parser.add_argument('--max-games', type=int, default=400)
+parser.add_argument('--metric', default='rank', choices=['rank', 'win'])
+parser.add_argument('--delta', type=float, default=0.1,
+                    help='Smallest interesting edge over a coin flip.')
+parser.add_argument('--alpha', type=float, default=0.05)
+parser.add_argument('--beta', type=float, default=0.05)
+parser.add_argument('--no-build', action='store_true')
+args = parser.parse_args()
+
+if not args.no_build:
+    os.system('set -e')
+    os.system('cmake .')
+    os.system('make')
+
+sizes = [int(s) for s in args.sizes.split(',')]
+
+
+class SPRT:
+    # Wald's test of H0: p = 0.5 against H1: p = 0.5 + delta on Bernoulli
+    # outcomes. Draws carry no information about p and are only counted.
+
+    def __init__(self, delta, alpha, beta):
+        self.p0 = 0.5
+        self.p1 = 0.5 + delta
+        self.lower = math.log(beta / (1 - alpha))
+        self.upper = math.log((1 - beta) / alpha)
+        self.llr = 0.0
+        self.wins = self.losses = self.draws = 0
+
+    def add(self, outcome):
+        if outcome > 0:
+            self.wins += 1
+            self.llr += math.log(self.p1 / self.p0)
+        elif outcome < 0:
+            self.losses += 1
+            self.llr += math.log((1 - self.p1) / (1 - self.p0))
+        else:
+            self.draws += 1
+
+    def verdict(self):
+        if self.llr >= self.upper:
+            return 'better'
+        if self.llr <= self.lower:
+            return 'not better'
+        return None
+
+    def confidence(self):
+        # One minus the one sided p-value of the observed wins under H0.
+        n = self.wins + self.losses
+        if not n:
+            return 0.0
+        z = (self.wins - 0.5 * n) / math.sqrt(0.25 * n)
+        return 0.5 * (1 + math.erf(z / math.sqrt(2)))
+
+    def __str__(self):
+        return 'W {} L {} D {} LLR {:.2f} [{:.2f}, {:.2f}] P(better) {:.3f}'.format(
+            self.wins, self.losses, self.draws, self.llr, self.lower,
+            self.upper, self.confidence())
+
+
+# Games still running when the test decides are killed rather than waited for.
+running = set()
+running_lock = threading.Lock()
+stopping = False
+
+
+def play(bot, seed, size):
+    bots = [bot] + [args.opponent] * (args.players - 1)
+    command = ['./halite', '--no-logs', '--no-replay', '--no-timeout',
+               '--results-as-json', '--width', str(size), '--height', str(size),
+               '--seed', str(seed)] + bots
+    with running_lock:
+        if stopping:
+            return None
+        process = subprocess.Popen(command, stdout=subprocess.PIPE,
+                                   stderr=subprocess.DEVNULL,
+                                   start_new_session=True)
+        running.add(process)
+    output = process.communicate()[0]
+    with running_lock:
+        running.discard(process)
+        if stopping:
+            return None
+    return json.loads(output.decode())['stats']['0']['rank']
+
+
+def stop(pool):
+    global stopping
+    pool.shutdown(wait=False, cancel_futures=True)
+    with running_lock:
+        stopping = True
+        for process in running:
+            # The engine's bots run in its session, so they go with it.
+            os.killpg(process.pid, signal.SIGKILL)
+
+
+def play_pair(seed, size):
+    return seed, size, play(args.candidate, seed, size), play(args.baseline, seed, size)
+
+
+def compare(u, v):
+    return (u < v) - (u > v)
+
+
+tests = {'rank': SPRT(args.delta, args.alpha, args.beta),
+         'win': SPRT(args.delta, args.alpha, args.beta)}
+
+games = 0
+verdict = None
+with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+    pending = set()
+
+    def schedule():
+        seed = randint(0, (1 << 31) - 1)
+        pending.add(pool.submit(play_pair, seed, sizes[seed % len(sizes)]))
+
+    for _ in range(min(args.jobs, args.max_games)):
+        schedule()
+    scheduled = len(pending)
+
+    while pending and verdict is None:
+        future = next(as_completed(pending))
+        pending.remove(future)
+        seed, size, rank_a, rank_b = future.result()
+        games += 1
+
+        tests['rank'].add(compare(rank_a, rank_b))
+        tests['win'].add((rank_a == 1) - (rank_b == 1))
+        print('{:4} seed {:10} size {} ranks {} {} | rank: {} | win: {}'.format(
+            games, seed, size, rank_a, rank_b, tests['rank'], tests['win']))
+        sys.stdout.flush()
+
+        verdict = tests[args.metric].verdict()
+        if verdict is None and scheduled < args.max_games:
+            schedule()
+            scheduled += 1
+
+    stop(pool)
+
+test = tests[args.metric]
+print('Stopped after {} game pairs.'.format(games))
+if verdict is None:
+    print('No verdict on {} within {} game pairs.'.format(args.metric, args.max_games))
+else:
+    print('Candidate is {} than baseline on {} (delta {}, alpha {}, beta {}).'.format(
+        verdict, args.metric, args.delta, args.alpha, args.beta))
+print('Confidence candidate is better: {:.3f}'.format(test.confidence()))
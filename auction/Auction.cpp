@@ -0,0 +1,180 @@
+#include "Auction.h"
+
+using namespace std;
+
+// Each phase divides epsilon by SCALING, down to RESOLUTION per row.
+static const double SCALING = 8.0;
+constexpr double AuctionAlgorithm::RESOLUTION;
+// Rounds with fewer row-column pairs than this bid on the calling thread.
+static const size_t PARALLEL_BIDS = 1 << 14;
+
+double AuctionAlgorithm::Solve(vector<vector<double>>& DistMatrix,
+                               vector<int>& Assignment) {
+    const size_t n = DistMatrix.size();
+    const size_t m = n ? DistMatrix[0].size() : 0;
+    Assignment.assign(n, -1);
+    if (!n || !m) return 0.0;
+
+    if (n <= m) {
+        solve(DistMatrix, Assignment);
+    } else {
+        vector<vector<double>> transposed(m, vector<double>(n));
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < m; ++j) transposed[j][i] = DistMatrix[i][j];
+
+        vector<int> column_assignment;
+        solve(transposed, column_assignment);
+        for (size_t j = 0; j < m; ++j) Assignment[column_assignment[j]] = j;
+    }
+
+    double cost = 0.0;
+    for (size_t i = 0; i < n; ++i)
+        if (Assignment[i] >= 0) cost += DistMatrix[i][Assignment[i]];
+    return cost;
+}
+
+void AuctionAlgorithm::solve(const vector<vector<double>>& cost,
+                             vector<int>& assignment) {
+    rows = cost.size();
+    columns = cost[0].size();
+
+    double low = numeric_limits<double>::infinity(), high = -low;
+    for (const vector<double>& row : cost) {
+        for (double c : row) {
+            low = min(low, c);
+            high = max(high, c);
+        }
+    }
+    const double range = max(high - low, 1.0);
+    const double final_epsilon = RESOLUTION / (rows + 1);
+
+    price.assign(columns, 0.0);
+    double epsilon = range / SCALING;
+    for (;;) {
+        epsilon = max(epsilon, final_epsilon);
+        bid(cost, epsilon);
+        // Columns left over keep the prices that bidding drove up. Lowering
+        // them at this phase's epsilon rather than only at the last one
+        // saves a long reverse price war between equal-cost columns.
+        reverse(cost, epsilon);
+        if (epsilon == final_epsilon) break;
+        epsilon /= SCALING;
+    }
+
+    assignment = row_column;
+}
+
+// Forward auction from the current prices until every row has a column.
+void AuctionAlgorithm::bid(const vector<vector<double>>& cost,
+                           double epsilon) {
+    row_column.assign(rows, -1);
+    column_row.assign(columns, -1);
+
+    vector<int> unassigned(rows), next_unassigned;
+    iota(unassigned.begin(), unassigned.end(), 0);
+    vector<pair<int, double>> bids(rows);
+    vector<int> best_bid(columns, -1), bid_columns;
+
+    auto make_bid = [&](size_t k, unsigned) {
+        const vector<double>& row = cost[unassigned[k]];
+        int best = 0;
+        double first = -numeric_limits<double>::infinity(), second = first;
+        for (size_t j = 0; j < columns; ++j) {
+            const double value = -row[j] - price[j];
+            if (value > first) {
+                second = first;
+                first = value;
+                best = j;
+            } else if (value > second) {
+                second = value;
+            }
+        }
+        if (columns == 1) second = first;
+        bids[k] = make_pair(best, price[best] + first - second + epsilon);
+    };
+
+    while (!unassigned.empty()) {
+        if (pool && unassigned.size() * columns >= PARALLEL_BIDS) {
+            pool->parallel_for(unassigned.size(), make_bid);
+        } else {
+            for (size_t k = 0; k < unassigned.size(); ++k) make_bid(k, 0);
+        }
+
+        // The highest bid for each column wins it.
+        bid_columns.clear();
+        for (size_t k = 0; k < unassigned.size(); ++k) {
+            int& best = best_bid[bids[k].first];
+            if (best < 0)
+                bid_columns.push_back(bids[k].first);
+            else if (bids[k].second <= bids[best].second)
+                continue;
+            best = k;
+        }
+
+        next_unassigned.clear();
+        for (size_t k = 0; k < unassigned.size(); ++k)
+            if (best_bid[bids[k].first] != int(k))
+                next_unassigned.push_back(unassigned[k]);
+        for (int j : bid_columns) {
+            const int k = best_bid[j];
+            const int i = unassigned[k];
+            price[j] = bids[k].second;
+            if (column_row[j] >= 0) {
+                row_column[column_row[j]] = -1;
+                next_unassigned.push_back(column_row[j]);
+            }
+            column_row[j] = i;
+            row_column[i] = j;
+            best_bid[j] = -1;
+        }
+        swap(unassigned, next_unassigned);
+    }
+}
+
+// Reverse iterations for columns left unassigned above the lowest assigned
+// price, after which no unassigned column could still have been preferred.
+// After the last phase this makes the assignment optimal to within RESOLUTION.
+void AuctionAlgorithm::reverse(const vector<vector<double>>& cost,
+                               double epsilon) {
+    vector<double> profit(rows);
+    double lambda = numeric_limits<double>::infinity();
+    for (size_t i = 0; i < rows; ++i) {
+        profit[i] = -cost[i][row_column[i]] - price[row_column[i]];
+        lambda = min(lambda, price[row_column[i]]);
+    }
+
+    vector<int> queue;
+    for (size_t j = 0; j < columns; ++j)
+        if (column_row[j] < 0 && price[j] > lambda) queue.push_back(j);
+
+    while (!queue.empty()) {
+        const int j = queue.back();
+        queue.pop_back();
+
+        int best = 0;
+        double first = -numeric_limits<double>::infinity(), second = first;
+        for (size_t i = 0; i < rows; ++i) {
+            const double value = -cost[i][j] - profit[i];
+            if (value > first) {
+                second = first;
+                first = value;
+                best = i;
+            } else if (value > second) {
+                second = value;
+            }
+        }
+
+        if (lambda >= first - epsilon) {
+            price[j] = lambda;
+            continue;
+        }
+        price[j] = first - min(first - lambda, first - second + epsilon);
+        profit[best] = -cost[best][j] - price[j];
+
+        const int previous = row_column[best];
+        column_row[previous] = -1;
+        if (price[previous] > lambda) queue.push_back(previous);
+        row_column[best] = j;
+        column_row[j] = best;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <bits/stdc++.h>
+
+/**
+ * Epsilon-scaling auction solver for the rectangular assignment problem, with
+ * the same contract as HungarianAlgorithm::Solve: every row gets a distinct
+ * column (or -1 when there are more rows than columns) minimizing the total
+ * cost, which is returned.
+ *
+ * Rows bid for their best column in Jacobi rounds, so the bids of a round are
+ * computed in parallel on the pool when one is given. Prices carry over from
+ * phase to phase while epsilon shrinks; every phase ends with reverse
+ * iterations that lower the prices of columns left unassigned, which makes
+ * the result optimal to within rows * epsilon for rectangular problems too.
+ */
+class AuctionAlgorithm {
+   public:
+    /**
+     * The smallest cost difference that matters: totals are optimal to within
+     * it, and costs closer than it may be traded as ties. The last phase's
+     * epsilon is RESOLUTION / (rows + 1), so costs on a grid of RESOLUTION
+     * are solved exactly.
+     */
+    static constexpr double RESOLUTION = 1e-3;
+
+    explicit AuctionAlgorithm(hlt::ThreadPool* pool = nullptr) : pool(pool) {}
+
+    double Solve(std::vector<std::vector<double>>& DistMatrix,
+                 std::vector<int>& Assignment);
+
+   private:
+    void solve(const std::vector<std::vector<double>>& cost,
+               std::vector<int>& assignment);
+    void bid(const std::vector<std::vector<double>>& cost, double epsilon);
+    void reverse(const std::vector<std::vector<double>>& cost,
+                 double epsilon);
+
+    hlt::ThreadPool* pool;
+
+    size_t rows, columns;
+    std::vector<double> price;
+    std::vector<int> row_column, column_row;
+};
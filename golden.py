@@ -0,0 +1,233 @@
+import argparse
+import os
+import re
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+
+# Decision-equivalence corpus. Games are recorded with the bot in deterministic
+# mode (--seed, --walks), keeping every frame it was sent and every command line
+# it answered with. Replaying the frames through a new build must reproduce the
+# same commands; the first divergent turn and ship are reported otherwise.
+# The transcripts under golden/ are committed, so checking needs no engine.
+#
+# Each seeds.txt game is recorded with the default flags, and the first 2 and
+# 4 player 32x32 games again with each of VARIANTS, so that the paths behind
+# those flags are checked too. Games from standin_engine.py are named
+# standin_*; they are shorter and not the official games of their seeds.
+#
+# python3 golden.py record                   # Record with ./halite and Jan20.
+# python3 golden.py record --engine standin  # Record what golden/ holds.
+# python3 golden.py check                    # Replay golden/ through ./MyBot.
+# python3 golden.py check --reference old    # Compare ./MyBot with old.
+
+CORPUS = 'golden'
+BOT_FLAGS = ['--seed', '1', '--walks', '100', '--trace', '0']
+VARIANTS = [
+    ('dp', ['--planner', 'dp']),
+    ('mcts', ['--planner', 'mcts']),
+    ('auction', ['--solver', 'auction']),
+    ('forecast', ['--forecast', '1', '--profile', '1', '--reserve', '1',
+                  '--inspire', '1']),
+    ('economy', ['--blur', '1', '--economy', '1', '--trips', '1']),
+    ('walks', ['--batch', '1', '--memory', '1', '--allocate', '1']),
+]
+# Stand-in games stop here, which brings the endgame into a quick check.
+STANDIN_TURNS = 150
+
+
+def proxy(path, bot):
+    # Sits between the engine and the bot, transcribing both directions.
+    # Lines sent to the bot are prefixed with '<', replies with '>'.
+    transcript = open(path, 'w')
+    transcript.write('# {}\n'.format(' '.join(bot[1:])))
+    process = subprocess.Popen(bot, stdin=subprocess.PIPE,
+                               stdout=subprocess.PIPE,
+                               universal_newlines=True, bufsize=1)
+
+    def forward(lines):
+        for line in lines:
+            transcript.write('<' + line)
+            process.stdin.write(line)
+        process.stdin.flush()
+        reply = process.stdout.readline()
+        transcript.write('>' + reply)
+        sys.stdout.write(reply)
+        sys.stdout.flush()
+
+    # Initialization is everything up to the end of the map.
+    header = [sys.stdin.readline() for _ in range(2)]
+    players = int(header[1].split()[0])
+    header += [sys.stdin.readline() for _ in range(players + 1)]
+    height = int(header[-1].split()[1])
+    header += [sys.stdin.readline() for _ in range(height)]
+    forward(header)
+
+    while True:
+        turn = sys.stdin.readline()
+        if not turn:
+            break
+        frame = [turn]
+        for _ in range(players):
+            line = sys.stdin.readline()
+            frame.append(line)
+            _, ships, dropoffs, _ = map(int, line.split())
+            frame += [sys.stdin.readline() for _ in range(ships + dropoffs)]
+        updates = sys.stdin.readline()
+        frame.append(updates)
+        frame += [sys.stdin.readline() for _ in range(int(updates))]
+        forward(frame)
+
+    process.stdin.close()
+    process.wait()
+
+
+def read_seeds():
+    # seeds.txt lists "N player (WxH):" headers followed by "seed S" entries.
+    games = []
+    players = size = None
+    for line in open('seeds.txt'):
+        header = re.search(r'(\d+) player \((\d+)x\d+\)', line)
+        if header:
+            players, size = int(header.group(1)), int(header.group(2))
+        seed = re.search(r'seed (\d+)', line)
+        if seed:
+            games.append((players, size, int(seed.group(1))))
+    return games
+
+
+def games():
+    # (name, players, size, seed, flags) for every transcript.
+    variant_seeds = {}
+    for players, size, seed in read_seeds():
+        yield '{}p_{}_{}'.format(players, size, seed), players, size, seed, []
+        if size == 32:
+            variant_seeds.setdefault(players, seed)
+    for players, seed in sorted(variant_seeds.items()):
+        for variant, flags in VARIANTS:
+            name = '{}p_32_{}_{}'.format(players, seed, variant)
+            yield name, players, 32, seed, flags
+
+
+def record(args):
+    os.makedirs(CORPUS, exist_ok=True)
+    for name, players, size, seed, flags in games():
+        if args.engine == 'standin':
+            name = 'standin_' + name
+            engine = ('python3 standin_engine.py --size {} --seed {} '
+                      '--turns {}'.format(size, seed, STANDIN_TURNS))
+        else:
+            engine = ('./halite --no-logs --no-replay --no-timeout --width {0} '
+                      '--height {0} --seed {1}'.format(size, seed))
+        path = os.path.join(CORPUS, name + '.txt')
+        bot = '"python3 golden.py proxy {} {} {}"'.format(
+            path, args.bot, ' '.join(BOT_FLAGS + flags))
+        if args.opponent:
+            opponents = [args.opponent] * (players - 1)
+        elif args.engine == 'standin':
+            # The bot itself, with walks of its own.
+            opponents = ['"{} --seed {} {}"'.format(
+                args.bot, i + 2, ' '.join(BOT_FLAGS[2:]))
+                for i in range(players - 1)]
+        else:
+            opponents = ['./bots/Jan20'] * (players - 1)
+        print('Recording', path)
+        os.system('{} {}'.format(engine, ' '.join([bot] + opponents)))
+
+
+def parse_commands(line):
+    # Maps each ship (or the shipyard, as 'g') to its command.
+    tokens = line.split()
+    commands = {}
+    i = 0
+    while i < len(tokens):
+        if tokens[i] == 'g':
+            commands['g'] = 'g'
+            i += 1
+        elif tokens[i] == 'c':
+            commands[tokens[i + 1]] = 'c'
+            i += 2
+        else:
+            commands[tokens[i + 1]] = tokens[i + 2]
+            i += 3
+    return commands
+
+
+def replay(bot, flags, frames):
+    # Traces do not change decisions, and would pile up here.
+    return subprocess.run([bot] + flags + ['--trace', '0'], input=frames,
+                          stdout=subprocess.PIPE,
+                          universal_newlines=True).stdout.splitlines(True)
+
+
+def replies(args, name):
+    # The (expected, actual) replies to a transcript's frames.
+    lines = open(os.path.join(CORPUS, name)).readlines()
+    flags = lines[0][1:].split()
+    frames = ''.join(line[1:] for line in lines if line[0] == '<')
+    if args.reference:
+        expected = replay(args.reference, flags, frames)
+    else:
+        expected = [line[1:] for line in lines if line[0] == '>']
+    return expected, replay(args.bot, flags, frames)
+
+
+def check(args):
+    failed = 0
+    names = sorted(os.listdir(CORPUS))
+    with ThreadPoolExecutor(args.jobs) as pool:
+        results = pool.map(lambda name: replies(args, name), names)
+    for name, (expected, actual) in zip(names, results):
+        divergence = None
+        for turn, (u, v) in enumerate(zip(expected, actual)):
+            if u == v:
+                continue
+            u, v = parse_commands(u), parse_commands(v)
+            ships = sorted(k for k in set(u) | set(v) if u.get(k) != v.get(k))
+            divergence = (turn, ships, u, v)
+            break
+        if divergence is None and len(actual) < len(expected):
+            divergence = (len(actual), [], {}, {})
+
+        if divergence is None:
+            print('OK  ', name, '({} turns)'.format(len(expected) - 1))
+            continue
+
+        failed += 1
+        turn, ships, u, v = divergence
+        print('DIFF', name, 'turn', turn)
+        if not ships:
+            print('     bot stopped responding')
+        for ship in ships:
+            print('     ship {}: expected {} got {}'.format(
+                ship, u.get(ship, '-'), v.get(ship, '-')))
+
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) > 1 and sys.argv[1] == 'proxy':
+        proxy(sys.argv[2], sys.argv[3:])
+        sys.exit(0)
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('mode', choices=['record', 'check'])
+    parser.add_argument('--bot', default='./MyBot')
+    parser.add_argument('--engine', default='halite',
+                        choices=['halite', 'standin'])
+    parser.add_argument('--opponent',
+                        help='Defaults to Jan20, or to the bot itself with '
+                             'other seeds under the stand-in engine.')
+    parser.add_argument('--reference',
+                        help='Check against this build\'s replies instead of '
+                             'the recorded ones.')
+    parser.add_argument('--jobs', type=int, default=os.cpu_count())
+    args = parser.parse_args()
+
+    if args.mode == 'record':
+        os.system('set -e')
+        os.system('cmake .')
+        os.system('make')
+        record(args)
+    else:
+        check(args)
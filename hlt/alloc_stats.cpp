@@ -0,0 +1,98 @@
+#include "alloc_stats.hpp"
+
+#ifdef ALLOC_STATS
+
+#include <cstdlib>
+
+namespace {
+
+// Each thread counts into its own slot, so the hot path never shares a
+// cache line; only the live byte count is global, for the peak.
+constexpr int MAX_THREADS = 64;
+
+struct alignas(64) Slot {
+    std::atomic<uint64_t> allocations, frees, bytes;
+};
+Slot slots[MAX_THREADS];
+std::atomic<int> used_slots(0);
+std::atomic<int64_t> live(0), peak(0);
+
+Slot& slot() {
+    // Threads past MAX_THREADS share the last slot.
+    static thread_local int index =
+        std::min(used_slots.fetch_add(1), MAX_THREADS - 1);
+    return slots[index];
+}
+
+// Every block carries its size in front, so delete knows what it frees.
+constexpr size_t HEADER = alignof(std::max_align_t);
+
+void* allocate(size_t size) {
+    void* block = std::malloc(size + HEADER);
+    if (!block) throw std::bad_alloc();
+    *static_cast<size_t*>(block) = size;
+
+    Slot& s = slot();
+    s.allocations.fetch_add(1, std::memory_order_relaxed);
+    s.bytes.fetch_add(size, std::memory_order_relaxed);
+    const int64_t now =
+        live.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t high = peak.load(std::memory_order_relaxed);
+    while (now > high &&
+           !peak.compare_exchange_weak(high, now, std::memory_order_relaxed))
+        ;
+    return static_cast<char*>(block) + HEADER;
+}
+
+void release(void* p) {
+    if (!p) return;
+    void* block = static_cast<char*>(p) - HEADER;
+    slot().frees.fetch_add(1, std::memory_order_relaxed);
+    live.fetch_sub(*static_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    release(p);
+}
+
+bool hlt::alloc::enabled() { return true; }
+
+hlt::alloc::Counts hlt::alloc::take() {
+    Counts counts;
+    const int threads = std::min(used_slots.load(), MAX_THREADS);
+    for (int i = 0; i < threads; ++i) {
+        counts.allocations += slots[i].allocations.exchange(0);
+        counts.frees += slots[i].frees.exchange(0);
+        counts.bytes += slots[i].bytes.exchange(0);
+    }
+    counts.peak = peak.exchange(live.load());
+    return counts;
+}
+
+#else
+
+bool hlt::alloc::enabled() { return false; }
+
+hlt::alloc::Counts hlt::alloc::take() { return Counts(); }
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+namespace alloc {
+
+/**
+ * Heap use over a stretch of the game. Only counted in builds configured
+ * with -DALLOC_STATS=ON, which replace the global operator new and delete;
+ * other builds always report zeros.
+ */
+struct Counts {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;
+    /** Most bytes live at once. */
+    int64_t peak = 0;
+
+    Counts& operator+=(const Counts& c) {
+        allocations += c.allocations;
+        frees += c.frees;
+        bytes += c.bytes;
+        peak = std::max(peak, c.peak);
+        return *this;
+    }
+};
+
+/** Whether this build counts allocations. */
+bool enabled();
+
+/**
+ * The counts of every thread since the last call, which starts the next
+ * stretch. Call it while no other thread is allocating.
+ */
+Counts take();
+
+}  // namespace alloc
+
+}  // namespace hlt
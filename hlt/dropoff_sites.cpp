@@ -0,0 +1,68 @@
+#include "dropoff_sites.hpp"
+
+void hlt::AxisDistances::update(const std::vector<int>& points, int size) {
+    // count[t] and weight[t] = t * count[t] as prefix sums over three copies
+    // of the axis.
+    std::vector<int64_t> count(3 * size + 1), weight(3 * size + 1);
+    for (int p : points) {
+        for (int copy = 0; copy < 3; ++copy) {
+            const int t = p + copy * size;
+            ++count[t + 1];
+            weight[t + 1] += t;
+        }
+    }
+    for (int t = 0; t < 3 * size; ++t) {
+        count[t + 1] += count[t];
+        weight[t + 1] += weight[t];
+    }
+
+    sums.resize(size);
+    for (int c = 0; c < size; ++c) {
+        const int center = c + size;
+        const int from = center - size / 2, to = from + size;
+        const int64_t left = center * (count[center] - count[from]) -
+                             (weight[center] - weight[from]);
+        const int64_t right = (weight[to] - weight[center]) -
+                              center * (count[to] - count[center]);
+        sums[c] = left + right;
+    }
+}
+
+void hlt::SiteIndex::update(const GameMap& map, const HaliteField& field) {
+    const int cells = map.width * map.height;
+    const int r = HaliteField::RADII[1], side = 2 * r + 1;
+    if (map.width != width || map.height != height ||
+        map.changed.size() * side * side > static_cast<size_t>(cells)) {
+        if (map.width != width || map.height != height) {
+            width = map.width;
+            height = map.height;
+            bounds.assign(cells, -1.0);
+            order.clear();
+        }
+        for (int32_t site = 0; site < cells; ++site) refresh(map, field, site);
+        return;
+    }
+
+    // A halite change moves the field's sums up to r cells away.
+    for (const Position& p : map.changed) {
+        for (int dy = -r; dy <= r; ++dy) {
+            const int y = (p.y + dy + height) % height;
+            for (int dx = -r; dx <= r; ++dx)
+                refresh(map, field, y * width + (p.x + dx + width) % width);
+        }
+    }
+}
+
+void hlt::SiteIndex::refresh(const GameMap& map, const HaliteField& field,
+                             int32_t site) {
+    const Position p(site % width, site / width);
+    const Halite around = field.sum(p, 1);
+    const double bound =
+        around < threshold ? -1.0
+                           : around * std::sqrt(map.cells[p.y][p.x].halite);
+    double& old = bounds[site];
+    if (bound == old) return;
+    if (old >= 0) order.erase(std::make_pair(old, site));
+    if (bound >= 0) order.emplace(bound, site);
+    old = bound;
+}
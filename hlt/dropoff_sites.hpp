@@ -0,0 +1,110 @@
+#pragma once
+
+#include "halite_field.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/**
+ * Sum of toroidal distances from every coordinate of an axis to a set of
+ * points on it. Each point is laid down three times over [0, 3 * size), so
+ * the nearest copy of every point to coordinate c lies in one window of size
+ * cells around c + size, and the window's sum is four prefix-sum lookups.
+ */
+class AxisDistances {
+   public:
+    void update(const std::vector<int>& points, int size);
+    int64_t at(int c) const { return sums[c]; }
+    /** The smallest sum over the axis. */
+    int64_t min() const {
+        return *std::min_element(sums.begin(), sums.end());
+    }
+
+   private:
+    std::vector<int64_t> sums;
+};
+
+/**
+ * Candidate dropoff sites, kept across turns in order of a bound on their
+ * score that only depends on the map: the halite in the field's square of
+ * radius 5 around the site times the square root of the site's own halite.
+ * Sites whose square holds less than the threshold are left out. A frame
+ * only moves the bounds of cells within that radius of GameMap::changed, at
+ * O(log n) each.
+ */
+class SiteIndex {
+   public:
+    explicit SiteIndex(Halite threshold) : threshold(threshold) {}
+
+    /** Brings the bounds up to date with the map's last frame; call it after
+     * updating the field. */
+    void update(const GameMap& map, const HaliteField& field);
+
+    /**
+     * Up to k (site, score) pairs with the highest positive score(site), best
+     * first, where sites are cell indices y * width + x. A site's score is at
+     * most its bound divided by distance(site), which is never below
+     * min_distance. Sites are scored from the highest bound down until no
+     * remaining one can beat the kth best score, so most are never scored.
+     * A site fills copies(site) of the k places, and is skipped at 0.
+     */
+    template <typename Distance, typename Copies, typename Score>
+    std::vector<std::pair<int32_t, double>> best(size_t k, double min_distance,
+                                                 Distance distance,
+                                                 Copies copies,
+                                                 Score score) const {
+        struct Found {
+            int32_t site;
+            int copies;
+            double score, bound;
+        };
+        // Ties go to the higher bound, then to the higher site.
+        auto better = [](const Found& u, const Found& v) {
+            return std::tie(u.score, u.bound, u.site) >
+                   std::tie(v.score, v.bound, v.site);
+        };
+        std::vector<Found> found;
+        if (!k) return {};
+        size_t places = 0;
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            const bool full = places >= k;
+            if (full && it->first / min_distance < found.back().score) break;
+            const int32_t site = it->second;
+            const int n = copies(site);
+            if (!n) continue;
+            const double bound = it->first / distance(site);
+            if (full && bound < found.back().score) continue;
+            const double s = score(site);
+            if (s <= 0) continue;
+
+            const Found f{site, n, s, bound};
+            found.insert(std::upper_bound(found.begin(), found.end(), f,
+                                          better),
+                         f);
+            places += n;
+            while (places - found.back().copies >= k) {
+                places -= found.back().copies;
+                found.pop_back();
+            }
+        }
+
+        std::vector<std::pair<int32_t, double>> sites;
+        for (const Found& f : found) {
+            for (int i = 0; i < f.copies && sites.size() < k; ++i)
+                sites.emplace_back(f.site, f.score);
+        }
+        return sites;
+    }
+
+   private:
+    Halite threshold;
+    int width = 0, height = 0;
+    /** Bound of every cell, or -1 if it is not a candidate. */
+    std::vector<double> bounds;
+    std::set<std::pair<double, int32_t>> order;
+
+    void refresh(const GameMap& map, const HaliteField& field, int32_t site);
+};
+
+}  // namespace hlt
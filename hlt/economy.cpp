@@ -0,0 +1,22 @@
+#include "economy.hpp"
+
+double hlt::Economy::project(const EconomyBranch& branch) const {
+    if (map_halite <= 0.0) return 0.0;
+
+    double value = 0.0, left = map_halite, boost = 1.0;
+    for (int t = turn; t < last_turn && left > 0.0; ++t) {
+        if (t == branch.spawn_turn) value -= constants::SHIP_COST;
+        if (t == branch.dropoff_turn) {
+            value -= branch.dropoff_cost;
+            boost = branch.dropoff_boost;
+        }
+        const bool spawned = branch.spawn_turn >= 0 &&
+                             t >= branch.spawn_turn &&
+                             branch.spawn_turn + trip <= last_turn;
+
+        const double density = left / map_halite;
+        value += (ships + spawned) * boost * income * density;
+        left -= ((ships + spawned) * boost + enemy_ships) * drain * density;
+    }
+    return value;
+}
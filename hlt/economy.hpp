@@ -0,0 +1,46 @@
+#pragma once
+
+#include "constants.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/** One course of action for the rest of the game. */
+struct EconomyBranch {
+    /** Turn a ship is spawned on, -1 for none. */
+    int spawn_turn = -1;
+    /** Turn a dropoff is built on, -1 for none. */
+    int dropoff_turn = -1;
+    /** What the dropoff costs us. */
+    double dropoff_cost = 0.0;
+    /** What the dropoff multiplies our ships' income by. */
+    double dropoff_boost = 1.0;
+};
+
+/**
+ * A fast-forward of the game's economy, aggregated over the fleet: every
+ * turn each ship takes halite off the map at a rate proportional to the
+ * halite left, our ships bank theirs, and everyone's mining depletes the
+ * map. A branch's value is the halite it banks by the last turn net of what
+ * it spends, so branches compare directly. A new ship that cannot finish a
+ * trip before the last turn banks nothing.
+ */
+struct Economy {
+    int turn;
+    int last_turn;
+    /** Halite on the map now. */
+    double map_halite;
+    /** Halite each of our ships banks per turn at today's map halite. */
+    double income;
+    /** Halite each ship takes off the map per turn at today's map halite. */
+    double drain;
+    /** Turns a mining trip takes. */
+    double trip;
+    int ships;
+    int enemy_ships;
+
+    double project(const EconomyBranch& branch) const;
+};
+
+}  // namespace hlt
@@ -0,0 +1,157 @@
+#include "explore_rates.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EXPLORE_RATES_AVX2 1
+#endif
+
+using namespace std;
+using namespace hlt;
+using namespace constants;
+
+void ExploreTargets::resize(size_t n) {
+    x.resize(n);
+    y.resize(n);
+    cell.resize(n);
+    halite.resize(n);
+    base_dist.resize(n);
+    for (std::vector<int32_t>& arrival : inspired) arrival.resize(n);
+    future_inspired.resize(n);
+    enemy_halite.resize(n);
+    neighbourhood.resize(n);
+}
+
+static float explore_rate(const ExploreTargets& t, size_t k, int x, int y,
+                          Halite ship_halite, bool future_inspire,
+                          const vector<int32_t>& dist) {
+    const int IBS = INSPIRED_BONUS_MULTIPLIER;
+
+    const int dx = abs(t.x[k] - x), dy = abs(t.y[k] - y);
+    const int d = min(dx, t.width - dx) + min(dy, t.height - dy);
+
+    const int arrival = min(d, INSPIRE_ARRIVALS - 1);
+    const bool inspired =
+        t.inspired[arrival][k] || (future_inspire && t.future_inspired[k]);
+    Halite profit = t.halite[k] - dist[t.cell[k]];
+    if (inspired) profit += IBS * t.halite[k];
+
+    if (t.enemy_halite[k] >= 0) {
+        Halite collision_halite = t.enemy_halite[k];
+        if (inspired) collision_halite += IBS * collision_halite;
+        if (profit + ship_halite < collision_halite) profit += collision_halite;
+    }
+    profit += t.neighbourhood[k];
+
+    profit = min(profit, MAX_HALITE - ship_halite);
+    const int turns = 1 + d + t.base_dist[k];
+    return static_cast<float>(profit) / static_cast<float>(turns);
+}
+
+#ifdef EXPLORE_RATES_AVX2
+
+#define AVX2 __attribute__((target("avx2")))
+
+namespace {
+
+AVX2 inline __m256i load_avx2(const vector<int32_t>& v, size_t k) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&v[k]));
+}
+
+AVX2 void explore_rates_avx2(const ExploreTargets& t, int x, int y,
+                             Halite ship_halite, bool future_inspire,
+                             const vector<int32_t>& dist,
+                             vector<float>& rates) {
+    const int IBS = INSPIRED_BONUS_MULTIPLIER;
+
+    const __m256i sx = _mm256_set1_epi32(x), sy = _mm256_set1_epi32(y);
+    const __m256i width = _mm256_set1_epi32(t.width);
+    const __m256i height = _mm256_set1_epi32(t.height);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i ibs = _mm256_set1_epi32(IBS);
+    const __m256i ship = _mm256_set1_epi32(ship_halite);
+    const __m256i room = _mm256_set1_epi32(MAX_HALITE - ship_halite);
+    const __m256i future = _mm256_set1_epi32(future_inspire ? -1 : 0);
+
+    const size_t n = t.size();
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        const __m256i dx =
+            _mm256_abs_epi32(_mm256_sub_epi32(load_avx2(t.x, k), sx));
+        const __m256i dy =
+            _mm256_abs_epi32(_mm256_sub_epi32(load_avx2(t.y, k), sy));
+        const __m256i d = _mm256_add_epi32(
+            _mm256_min_epi32(dx, _mm256_sub_epi32(width, dx)),
+            _mm256_min_epi32(dy, _mm256_sub_epi32(height, dy)));
+
+        // The inspiration of the arrival turn, or of the last one known.
+        __m256i inspired =
+            _mm256_and_si256(future, load_avx2(t.future_inspired, k));
+        for (int a = 0; a < INSPIRE_ARRIVALS; ++a) {
+            const __m256i arrival =
+                a + 1 < INSPIRE_ARRIVALS
+                    ? _mm256_cmpeq_epi32(d, _mm256_set1_epi32(a))
+                    : _mm256_cmpgt_epi32(d, _mm256_set1_epi32(a - 1));
+            inspired = _mm256_or_si256(
+                inspired,
+                _mm256_and_si256(arrival, load_avx2(t.inspired[a], k)));
+        }
+        const __m256i halite = load_avx2(t.halite, k);
+        const __m256i path = _mm256_i32gather_epi32(
+            dist.data(), load_avx2(t.cell, k), 4);
+        __m256i profit = _mm256_sub_epi32(halite, path);
+        profit = _mm256_add_epi32(
+            profit,
+            _mm256_and_si256(inspired, _mm256_mullo_epi32(ibs, halite)));
+
+        __m256i collision = load_avx2(t.enemy_halite, k);
+        const __m256i enemy =
+            _mm256_cmpgt_epi32(collision, _mm256_set1_epi32(-1));
+        collision = _mm256_add_epi32(
+            collision,
+            _mm256_and_si256(inspired, _mm256_mullo_epi32(ibs, collision)));
+        const __m256i take = _mm256_and_si256(
+            enemy, _mm256_cmpgt_epi32(collision,
+                                      _mm256_add_epi32(profit, ship)));
+        profit = _mm256_add_epi32(profit, _mm256_and_si256(take, collision));
+        profit = _mm256_add_epi32(profit, load_avx2(t.neighbourhood, k));
+
+        profit = _mm256_min_epi32(profit, room);
+        const __m256i turns = _mm256_add_epi32(_mm256_add_epi32(one, d),
+                                               load_avx2(t.base_dist, k));
+        _mm256_storeu_ps(&rates[k], _mm256_div_ps(_mm256_cvtepi32_ps(profit),
+                                                  _mm256_cvtepi32_ps(turns)));
+    }
+    for (; k < n; ++k)
+        rates[k] = explore_rate(t, k, x, y, ship_halite, future_inspire, dist);
+}
+
+}  // namespace
+
+#endif
+
+void hlt::explore_rates(const ExploreTargets& targets, int x, int y,
+                        Halite ship_halite, bool future_inspire,
+                        const vector<int32_t>& dist, vector<float>& rates) {
+    rates.resize(targets.size());
+#ifdef EXPLORE_RATES_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        explore_rates_avx2(targets, x, y, ship_halite, future_inspire, dist,
+                           rates);
+        return;
+    }
+#endif
+    explore_rates_scalar(targets, x, y, ship_halite, future_inspire, dist,
+                         rates);
+}
+
+void hlt::explore_rates_scalar(const ExploreTargets& targets, int x, int y,
+                               Halite ship_halite, bool future_inspire,
+                               const vector<int32_t>& dist,
+                               vector<float>& rates) {
+    rates.resize(targets.size());
+    for (size_t k = 0; k < targets.size(); ++k) {
+        rates[k] =
+            explore_rate(targets, k, x, y, ship_halite, future_inspire, dist);
+    }
+}
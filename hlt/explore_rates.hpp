@@ -0,0 +1,57 @@
+#pragma once
+
+#include "constants.hpp"
+#include "types.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/** Arrival times targets know their inspiration for; later arrivals use the
+ * last one. */
+constexpr int INSPIRE_ARRIVALS = 4;
+
+/**
+ * What the explorer cost rows need to know about each target, as parallel
+ * arrays in target order so a ship's whole row is a single pass.
+ */
+struct ExploreTargets {
+    int width, height;
+    std::vector<int32_t> x, y;
+    /** Index of the target's cell in a per-cell array, y * width + x. */
+    std::vector<int32_t> cell;
+    std::vector<int32_t> halite;
+    /** Distance from the target to its closest base. */
+    std::vector<int32_t> base_dist;
+    /** inspired[a]: -1 if mining the target on arriving in a turns is
+     * inspired, 0 otherwise. */
+    std::array<std::vector<int32_t>, INSPIRE_ARRIVALS> inspired;
+    /** -1 if the target is close enough to the planned dropoff to be
+     * inspired once it is built, 0 otherwise. */
+    std::vector<int32_t> future_inspired;
+    /** Halite of an enemy worth colliding with on the target, -1 if none. */
+    std::vector<int32_t> enemy_halite;
+    /** Halite the cells around the target add to a trip there. */
+    std::vector<int32_t> neighbourhood;
+
+    void resize(size_t n);
+    size_t size() const { return x.size(); }
+};
+
+/**
+ * Halite per turn the ship at (x, y) carrying ship_halite expects from each
+ * target, given its path cost to every cell in dist. future_inspire says
+ * whether the planned dropoff's inspiration counts for this ship. Uses AVX2
+ * when the host has it; the scalar path gives identical results.
+ */
+void explore_rates(const ExploreTargets& targets, int x, int y,
+                   Halite ship_halite, bool future_inspire,
+                   const std::vector<int32_t>& dist, std::vector<float>& rates);
+
+/** explore_rates() without AVX2, which tests check the AVX2 path against. */
+void explore_rates_scalar(const ExploreTargets& targets, int x, int y,
+                          Halite ship_halite, bool future_inspire,
+                          const std::vector<int32_t>& dist,
+                          std::vector<float>& rates);
+
+}  // namespace hlt
@@ -0,0 +1,117 @@
+#include "fleet_stats.hpp"
+
+constexpr double hlt::QuantileSketch::GAMMA;
+constexpr int hlt::QuantileSketch::BINS;
+constexpr int hlt::QuantileSketch::BLOCKS;
+constexpr int hlt::QuantileSketch::BLOCK_TURNS;
+constexpr int hlt::QuantileSketch::WINDOW;
+
+int hlt::QuantileSketch::bin(double value) {
+    // Bin 0 holds everything below 1.
+    if (value < 1.0) return 0;
+    const int b = 1 + static_cast<int>(std::log(value) / std::log(GAMMA));
+    return std::min(b, BINS - 1);
+}
+
+void hlt::QuantileSketch::advance(int turn) {
+    const int now = turn / BLOCK_TURNS;
+    if (block < 0) block = now;
+    for (; block < now; ++block) {
+        Counts& expired = blocks[(block + 1) % BLOCKS];
+        for (int b = 0; b < BINS; ++b) total.bins[b] -= expired.bins[b];
+        total.count -= expired.count;
+        total.sum -= expired.sum;
+        expired = Counts();
+    }
+}
+
+void hlt::QuantileSketch::add(int turn, double value) {
+    advance(turn);
+    Counts& current = blocks[block % BLOCKS];
+    const int b = bin(value);
+    for (Counts* counts : {&current, &total}) {
+        ++counts->bins[b];
+        ++counts->count;
+        counts->sum += value;
+    }
+}
+
+double hlt::QuantileSketch::quantile(double q) const {
+    if (!total.count) return 0.0;
+    const int rank = std::min<int>(total.count - 1, q * total.count);
+    int seen = 0;
+    for (int b = 0; b < BINS; ++b) {
+        seen += total.bins[b];
+        if (seen <= rank) continue;
+        // The geometric middle of the bin [GAMMA^(b-1), GAMMA^b).
+        return b ? std::pow(GAMMA, b - 0.5) : 0.0;
+    }
+    return std::pow(GAMMA, BINS - 1);
+}
+
+void hlt::FleetStats::update(const Game& game) {
+    const GameMap& game_map = *game.game_map;
+    const Player& me = *game.me;
+    const int turn = game.turn_number;
+
+    for (auto it = trips.begin(); it != trips.end();) {
+        if (me.ships.count(it->first))
+            ++it;
+        else
+            it = trips.erase(it);
+    }
+
+    for (auto& it : me.ships) {
+        const Ship& ship = *it.second;
+        const Position p = ship.position;
+        const Halite cell_halite = game_map.cells[p.y][p.x].halite;
+
+        auto found = trips.find(ship.id);
+        if (found == trips.end()) {
+            trips[ship.id] = {turn, p, ship.halite, cell_halite, 0, 0};
+            continue;
+        }
+        Trip& trip = found->second;
+
+        if (p != trip.position) {
+            const Halite cost =
+                trip.cell_halite / constants::MOVE_COST_RATIO;
+            trip.burned += cost;
+
+            bool at_base = p == me.shipyard->position;
+            for (auto& dropoff : me.dropoffs)
+                at_base |= p == dropoff.second->position;
+            if (at_base && trip.halite > 0 && ship.halite == 0) {
+                trip_turns.add(turn, turn - trip.start);
+                trip_halite.add(turn, trip.halite - cost);
+                idle_turns.add(turn, trip.idle);
+                burned.add(turn, trip.burned);
+                trip = {turn, p, 0, cell_halite, 0, 0};
+                continue;
+            }
+        } else if (ship.halite == trip.halite) {
+            ++trip.idle;
+        }
+        trip.position = p;
+        trip.halite = ship.halite;
+        trip.cell_halite = cell_halite;
+    }
+
+    for (QuantileSketch* sketch :
+         {&trip_turns, &trip_halite, &idle_turns, &burned})
+        sketch->advance(turn);
+}
+
+void hlt::FleetStats::dump() const {
+    const std::array<std::pair<const char*, const QuantileSketch*>, 4>
+        sketches = {{{"trip_turns", &trip_turns},
+                     {"trip_halite", &trip_halite},
+                     {"idle_turns", &idle_turns},
+                     {"burned", &burned}}};
+    for (auto& it : sketches) {
+        const QuantileSketch& s = *it.second;
+        log::log("Fleet", it.first, "count", s.count(), "mean", s.mean(),
+                 "p10", s.quantile(0.1), "p50", s.quantile(0.5), "p90",
+                 s.quantile(0.9));
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "game.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/**
+ * Quantiles of the values seen over the last WINDOW turns. Values go into
+ * log-spaced bins GAMMA apart, so a quantile is within GAMMA of the true
+ * one. The window is BLOCKS blocks of turns, each with its own bin counts;
+ * the oldest block is taken out of the totals when a new one starts, so
+ * memory stays at BLOCKS * BINS counts however long the game runs.
+ */
+class QuantileSketch {
+   public:
+    static constexpr double GAMMA = 1.1;
+    static constexpr int BINS = 128;
+    static constexpr int BLOCKS = 8;
+    static constexpr int BLOCK_TURNS = 25;
+    static constexpr int WINDOW = BLOCKS * BLOCK_TURNS;
+
+    /** Drops the blocks that are out of the window on turn. */
+    void advance(int turn);
+    void add(int turn, double value);
+
+    int count() const { return total.count; }
+    double mean() const { return total.count ? total.sum / total.count : 0; }
+    /** The value at quantile q in [0, 1], or 0 with no values. */
+    double quantile(double q) const;
+
+   private:
+    struct Counts {
+        std::array<int, BINS> bins{};
+        int count = 0;
+        double sum = 0.0;
+    };
+    std::array<Counts, BLOCKS> blocks;
+    Counts total;
+    int block = -1;
+
+    static int bin(double value);
+};
+
+/**
+ * Our fleet's mining trips, from one deposit (or the ship's spawn) to the
+ * next, read off consecutive frames. Updating is O(1) per ship.
+ */
+class FleetStats {
+   public:
+    void update(const Game& game);
+
+    /** Turns from leaving a base to depositing. */
+    QuantileSketch trip_turns;
+    /** Halite deposited at the end of a trip. */
+    QuantileSketch trip_halite;
+    /** Turns of a trip spent standing on a cell without mining. */
+    QuantileSketch idle_turns;
+    /** Halite spent on moves during a trip. */
+    QuantileSketch burned;
+
+    /** Logs every distribution. */
+    void dump() const;
+
+   private:
+    struct Trip {
+        int start;
+        Position position;
+        Halite halite, cell_halite, burned;
+        int idle;
+    };
+    std::unordered_map<EntityId, Trip> trips;
+};
+
+}  // namespace hlt
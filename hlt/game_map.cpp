@@ -13,13 +13,18 @@ void GameMap::_update() {
 
     int update_count;
     get_sstream() >> update_count;
+    changed.clear();
 
     for (int i = 0; i < update_count; ++i) {
         int x;
         int y;
         int halite;
         get_sstream() >> x >> y >> halite;
-        cells[y][x].halite = halite;
+        Halite& cell_halite = cells[y][x].halite;
+        total_halite += halite - cell_halite;
+        halite_cells += (halite > 0) - (cell_halite > 0);
+        cell_halite = halite;
+        changed.emplace_back(x, y);
     }
 }
 
@@ -38,6 +43,8 @@ unique_ptr<GameMap> GameMap::_generate() {
             in >> halite;
 
             map->cells[y].push_back(MapCell(x, y, halite));
+            map->total_halite += halite;
+            map->halite_cells += halite > 0;
         }
     }
 
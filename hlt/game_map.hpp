@@ -10,6 +10,13 @@ struct GameMap {
     int width;
     int height;
     std::vector<std::vector<MapCell>> cells;
+    /** Cells whose halite the last frame reported. Anything derived from
+     * halite only needs to look at these. */
+    std::vector<Position> changed;
+    /** Halite on the whole map. */
+    Halite total_halite = 0;
+    /** Number of cells with any halite. */
+    int halite_cells = 0;
 
     MapCell* at(const Position& position) {
         Position normalized = normalize(position);
@@ -24,7 +31,7 @@ struct GameMap {
         return at(entity->position);
     }
 
-    int calc_dist(const Position& source, const Position& target) {
+    int calc_dist(const Position& source, const Position& target) const {
         const auto& normalized_source = normalize(source);
         const auto& normalized_target = normalize(target);
 
@@ -37,7 +44,7 @@ struct GameMap {
         return toroidal_dx + toroidal_dy;
     }
 
-    Position normalize(const Position& position) {
+    Position normalize(const Position& position) const {
         const int x = ((position.x % width) + width) % width;
         const int y = ((position.y % height) + height) % height;
         return {x, y};
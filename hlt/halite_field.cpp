@@ -0,0 +1,89 @@
+#include "halite_field.hpp"
+
+constexpr std::array<int, hlt::HaliteField::SCALES> hlt::HaliteField::RADII;
+
+void hlt::HaliteField::update(const GameMap& map) {
+    if (map.width != width || map.height != height) {
+        reset(map);
+        return;
+    }
+
+    std::vector<std::pair<int, int32_t>> deltas;
+    for (const Position& p : map.changed) {
+        const int i = p.y * width + p.x;
+        const Halite now = map.cells[p.y][p.x].halite;
+        if (now == halite[i]) continue;
+        deltas.emplace_back(i, now - halite[i]);
+        halite[i] = now;
+    }
+    if (deltas.empty()) return;
+
+    for (int s = 0; s < SCALES; ++s) {
+        const int r = radius[s], side = 2 * r + 1;
+        // A delta touches side^2 sums; a rebuild reads the map twice.
+        if (deltas.size() * side * side > 2u * halite.size()) {
+            rebuild(s);
+            continue;
+        }
+
+        for (const std::pair<int, int32_t>& delta : deltas) {
+            const int x = delta.first % width, y = delta.first / width;
+            for (int dy = -r; dy <= r; ++dy) {
+                int32_t* row = &sums[s][(y + dy + height) % height * width];
+                int xx = (x - r + width) % width;
+                for (int dx = 0; dx < side; ++dx) {
+                    row[xx] += delta.second;
+                    if (++xx == width) xx = 0;
+                }
+            }
+        }
+    }
+}
+
+double hlt::HaliteField::blurred(const Position& p) const {
+    double total = 0.0;
+    for (int s = 0; s < SCALES; ++s) total += mean(p, s);
+    return total / SCALES;
+}
+
+void hlt::HaliteField::reset(const GameMap& map) {
+    width = map.width;
+    height = map.height;
+    halite.resize(width * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x)
+            halite[y * width + x] = map.cells[y][x].halite;
+    }
+    for (int s = 0; s < SCALES; ++s) {
+        radius[s] = std::min(RADII[s], (std::min(width, height) - 1) / 2);
+        rebuild(s);
+    }
+}
+
+void hlt::HaliteField::rebuild(int scale) {
+    const int r = radius[scale];
+    std::vector<int32_t> rows(width * height);
+    std::vector<int32_t>& sum = sums[scale];
+    sum.assign(width * height, 0);
+
+    // Sliding windows along each row, then down each column of the result.
+    for (int y = 0; y < height; ++y) {
+        const Halite* in = &halite[y * width];
+        int32_t window = 0;
+        for (int dx = -r; dx <= r; ++dx) window += in[(dx + width) % width];
+        for (int x = 0; x < width; ++x) {
+            rows[y * width + x] = window;
+            window += in[(x + r + 1) % width] - in[(x - r + width) % width];
+        }
+    }
+    for (int x = 0; x < width; ++x) {
+        int32_t window = 0;
+        for (int dy = -r; dy <= r; ++dy)
+            window += rows[(dy + height) % height * width + x];
+        for (int y = 0; y < height; ++y) {
+            sum[y * width + x] = window;
+            window += rows[(y + r + 1) % height * width + x] -
+                      rows[(y - r + height) % height * width + x];
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "game_map.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/**
+ * The map's halite box-filtered at a few radii on the torus. Each scale keeps
+ * the exact sum over the (2r + 1)^2 square around every cell, so a frame only
+ * moves the sums by the halite deltas of GameMap::changed; a scale is rebuilt
+ * with two sliding-window passes instead when that is cheaper. Averaging the
+ * scales gives a peaked kernel, a cheap stand-in for a Gaussian blur.
+ */
+class HaliteField {
+   public:
+    static constexpr int SCALES = 3;
+    /** Radius of each scale. A square of radius 5 holds a dropoff's
+     * catchment of cells at most 5 away. */
+    static constexpr std::array<int, SCALES> RADII = {{2, 5, 8}};
+
+    /** Brings every scale up to date with the map's last frame. */
+    void update(const GameMap& map);
+
+    /** Halite in the square of RADII[scale] around p. */
+    int32_t sum(const Position& p, int scale) const {
+        return sums[scale][p.y * width + p.x];
+    }
+    /** Average halite per cell in the square of RADII[scale] around p. */
+    double mean(const Position& p, int scale) const {
+        const int side = 2 * radius[scale] + 1;
+        return static_cast<double>(sum(p, scale)) / (side * side);
+    }
+    /** Average of the scales' means. */
+    double blurred(const Position& p) const;
+
+   private:
+    int width = 0, height = 0;
+    /** RADII, capped so that a square does not wrap onto itself. */
+    std::array<int, SCALES> radius;
+    std::vector<Halite> halite;
+    std::array<std::vector<int32_t>, SCALES> sums;
+
+    void reset(const GameMap& map);
+    void rebuild(int scale);
+};
+
+}  // namespace hlt
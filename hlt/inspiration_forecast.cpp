@@ -0,0 +1,46 @@
+#include "inspiration_forecast.hpp"
+
+void hlt::InspirationForecast::update(const OccupancyForecast& forecast,
+                                      int width, int height) {
+    this->width = width;
+    this->height = height;
+    const int cells = width * height;
+    const int radius = constants::INSPIRATION_RADIUS;
+    probability.resize(HORIZON * cells);
+
+    // Row prefix sums over two copies of each row, so that any wrapped
+    // segment of at most width cells is one difference.
+    std::vector<double> prefix(height * (2 * width + 1));
+    for (int t = 1; t <= HORIZON; ++t) {
+        const float* ships = forecast.expected(t);
+        for (int y = 0; y < height; ++y) {
+            double* row = &prefix[y * (2 * width + 1)];
+            row[0] = 0.0;
+            for (int x = 0; x < 2 * width; ++x)
+                row[x + 1] = row[x] + ships[y * width + x % width];
+        }
+
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                double lambda = 0.0;
+                for (int dy = -radius; dy <= radius; ++dy) {
+                    const int r = std::min(radius - std::abs(dy),
+                                           (width - 1) / 2);
+                    const int yy = ((y + dy) % height + height) % height;
+                    const double* row = &prefix[yy * (2 * width + 1)];
+                    const int from = (x - r + width) % width;
+                    lambda += row[from + 2 * r + 1] - row[from];
+                }
+
+                // P(count >= INSPIRATION_SHIP_COUNT) for a Poisson count.
+                double term = std::exp(-lambda), below = 0.0;
+                for (int i = 0; i < constants::INSPIRATION_SHIP_COUNT; ++i) {
+                    below += term;
+                    term *= lambda / (i + 1);
+                }
+                probability[(t - 1) * cells + y * width + x] =
+                    std::max(0.0, 1.0 - below);
+            }
+        }
+    }
+}
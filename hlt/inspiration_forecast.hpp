@@ -0,0 +1,34 @@
+#pragma once
+
+#include "occupancy_forecast.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/**
+ * Which cells will be inspired over the next OccupancyForecast::HORIZON
+ * turns. The expected number of enemy ships within INSPIRATION_RADIUS of a
+ * cell is summed over the forecast's projected positions with a diamond
+ * kernel, and taken as the mean of a Poisson count.
+ */
+class InspirationForecast {
+   public:
+    static constexpr int HORIZON = OccupancyForecast::HORIZON;
+
+    void update(const OccupancyForecast& forecast, int width, int height);
+
+    /** Probability that mining p in 1 <= turns <= HORIZON is inspired. */
+    float at(const Position& p, int turns) const {
+        return probability[(turns - 1) * width * height + p.y * width + p.x];
+    }
+    bool inspired(const Position& p, int turns) const {
+        return at(p, turns) >= 0.5f;
+    }
+
+   private:
+    int width = 0, height = 0;
+    std::vector<float> probability;
+};
+
+}  // namespace hlt
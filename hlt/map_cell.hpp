@@ -20,7 +20,6 @@ struct MapCell {
     int close_allies = 0;
     int close_enemies = 0;
     bool really_there = false;
-    std::unordered_map<Direction, size_t> close_ships;
 
     MapCell(int x, int y, Halite halite)
         : position(x, y), halite(halite), closest_base(position) {}
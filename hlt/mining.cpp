@@ -0,0 +1,86 @@
+#include "mining.hpp"
+#include "constants.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace hlt;
+using namespace constants;
+
+// left[k][h] is the halite left on a cell with h halite after k mines, and
+// gained[k][h] what an inspired ship gains from them, with no cargo limit.
+static std::vector<Halite> left, gained;
+
+static size_t index(int turns, Halite cell_halite) {
+    return turns * (mining::MAX_TABLE_HALITE + 1) + cell_halite;
+}
+
+static Halite extracted(Halite h) {
+    return (h + EXTRACT_RATIO - 1) / EXTRACT_RATIO;
+}
+
+static Halite inspired_bonus(Halite mined) {
+    return static_cast<Halite>(INSPIRED_BONUS_MULTIPLIER * mined);
+}
+
+void hlt::mining::populate_tables() {
+    const size_t size = index(MAX_MINES + 1, 0);
+    left.assign(size, 0);
+    gained.assign(size, 0);
+    for (Halite h = 0; h <= MAX_TABLE_HALITE; ++h) {
+        left[index(0, h)] = h;
+        for (int k = 1; k <= MAX_MINES; ++k) {
+            const Halite mined = extracted(left[index(k - 1, h)]);
+            left[index(k, h)] = left[index(k - 1, h)] - mined;
+            gained[index(k, h)] =
+                gained[index(k - 1, h)] + mined + inspired_bonus(mined);
+        }
+    }
+}
+
+void hlt::mining::mine(Halite& cargo, Halite& cell_halite, int turns,
+                       bool inspired) {
+    if (cell_halite > MAX_TABLE_HALITE || turns > MAX_MINES || left.empty()) {
+        for (int k = 0; k < turns; ++k) {
+            const Halite mined =
+                std::min(extracted(cell_halite), MAX_HALITE - cargo);
+            cargo += mined;
+            if (inspired) {
+                cargo += inspired_bonus(mined);
+                cargo = std::min(cargo, MAX_HALITE);
+            }
+            cell_halite -= mined;
+        }
+        return;
+    }
+
+    // Without inspiration the cargo limit only cuts the total short.
+    if (!inspired) {
+        const Halite mined = std::min(
+            cell_halite - left[index(turns, cell_halite)], MAX_HALITE - cargo);
+        cargo += mined;
+        cell_halite -= mined;
+        return;
+    }
+
+    // With it, mining is unlimited up to the turn the ship fills up on, and
+    // nothing is mined after.
+    int lo = 0, hi = turns;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (cargo + gained[index(mid + 1, cell_halite)] >= MAX_HALITE)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    if (lo == turns) {
+        cargo += gained[index(turns, cell_halite)];
+        cell_halite = left[index(turns, cell_halite)];
+        return;
+    }
+    const Halite before = left[index(lo, cell_halite)];
+    const Halite mined = std::min(
+        extracted(before), MAX_HALITE - cargo - gained[index(lo, cell_halite)]);
+    cargo = MAX_HALITE;
+    cell_halite = before - mined;
+}
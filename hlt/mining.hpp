@@ -0,0 +1,25 @@
+#pragma once
+
+#include "types.hpp"
+
+namespace hlt {
+
+/**
+ * Tables of what mining the same cell for several consecutive turns yields,
+ * built once from the constants. Cells richer than MAX_TABLE_HALITE and
+ * sequences longer than MAX_MINES are simulated turn by turn instead.
+ */
+namespace mining {
+
+constexpr int MAX_MINES = 64;
+constexpr Halite MAX_TABLE_HALITE = 4095;
+
+void populate_tables();
+
+/** Mines a cell with cell_halite halite for turns turns with a ship carrying
+ * cargo, updating both. */
+void mine(Halite& cargo, Halite& cell_halite, int turns, bool inspired);
+
+}  // namespace mining
+
+}  // namespace hlt
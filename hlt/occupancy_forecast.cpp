@@ -0,0 +1,91 @@
+#include "occupancy_forecast.hpp"
+
+int hlt::OccupancyForecast::bucket(Halite cell_halite, Halite ship_halite) {
+    int b = 0;
+    if (cell_halite >= 25) ++b;
+    if (cell_halite >= 100) ++b;
+    if (cell_halite >= 250) ++b;
+    const Halite mined =
+        (cell_halite + constants::EXTRACT_RATIO - 1) / constants::EXTRACT_RATIO;
+    if (constants::MAX_HALITE - ship_halite < mined) b += 4;
+    return b;
+}
+
+double hlt::OccupancyForecast::stay(PlayerId player, Halite cell_halite,
+                                    Halite ship_halite) const {
+    if (size_t(player) >= moves.size()) return 0.5;
+    const std::array<int, 2>& counts =
+        moves[player][bucket(cell_halite, ship_halite)];
+    return (counts[0] + 1.0) / (counts[0] + counts[1] + 2.0);
+}
+
+void hlt::OccupancyForecast::update(const Game& game) {
+    const GameMap& game_map = *game.game_map;
+    width = game_map.width;
+    height = game_map.height;
+    const int cells = width * height;
+    moves.resize(game.players.size());
+
+    std::unordered_map<EntityId, Sighting> seen;
+    std::vector<double> free(HORIZON * cells, 1.0);
+    ships.assign(HORIZON * cells, 0.0f);
+    std::vector<double> mass(cells), next(cells);
+    std::vector<int> touched, next_touched;
+
+    for (auto& player : game.players) {
+        if (player->id == game.my_id) continue;
+        for (auto& it : player->ships) {
+            const Ship& ship = *it.second;
+            const Position p = ship.position;
+            const MapCell& cell = game_map.cells[p.y][p.x];
+
+            auto last = last_seen.find(ship.id);
+            if (last != last_seen.end() && !last->second.stuck) {
+                const Sighting& s = last->second;
+                ++moves[player->id][bucket(s.cell_halite, s.ship_halite)]
+                       [s.position != p];
+            }
+            const bool stuck =
+                ship.halite < cell.halite / constants::MOVE_COST_RATIO;
+            seen[ship.id] = {p, cell.halite, ship.halite, stuck};
+
+            // Spread the ship over the cells it can reach, turn by turn.
+            touched.assign(1, p.y * width + p.x);
+            mass[touched[0]] = 1.0;
+            for (int t = 0; t < HORIZON; ++t) {
+                next_touched.clear();
+                for (int c : touched) {
+                    const Position q(c % width, c / width);
+                    const double s =
+                        t == 0 && stuck
+                            ? 1.0
+                            : stay(player->id, game_map.cells[q.y][q.x].halite,
+                                   ship.halite);
+                    auto add = [&](int d, double m) {
+                        if (m <= 0.0) return;
+                        if (next[d] == 0.0) next_touched.push_back(d);
+                        next[d] += m;
+                    };
+                    add(c, mass[c] * s);
+                    for (Direction d : ALL_CARDINALS) {
+                        const Position r = game_map.normalize(q.doff(d));
+                        add(r.y * width + r.x, mass[c] * (1 - s) / 4);
+                    }
+                    mass[c] = 0.0;
+                }
+                for (int c : next_touched) {
+                    free[t * cells + c] *= 1.0 - std::min(1.0, next[c]);
+                    ships[t * cells + c] += next[c];
+                    mass[c] = next[c];
+                    next[c] = 0.0;
+                }
+                std::swap(touched, next_touched);
+            }
+            for (int c : touched) mass[c] = 0.0;
+        }
+    }
+    last_seen = std::move(seen);
+
+    occupancy.resize(free.size());
+    for (size_t i = 0; i < free.size(); ++i) occupancy[i] = 1.0 - free[i];
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "game.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/**
+ * Where enemy ships will be over the next HORIZON turns. Each opponent's ships
+ * are modelled as staying still with a probability learned from how often
+ * that opponent's ships stayed in similar situations (halite under the ship,
+ * and whether its hold is too full to mine more), and otherwise moving to a
+ * uniformly random neighbour.
+ */
+class OccupancyForecast {
+   public:
+    static constexpr int HORIZON = 3;
+
+    /** Learns from the moves since the last call and rebuilds the grids. */
+    void update(const Game& game);
+
+    /** Probability that some enemy ship is on p in 1 <= turns <= HORIZON. */
+    float at(const Position& p, int turns) const {
+        return occupancy[(turns - 1) * width * height + p.y * width + p.x];
+    }
+
+    /** Expected number of enemy ships on each cell in turns turns, indexed by
+     * y * width + x. */
+    const float* expected(int turns) const {
+        return &ships[(turns - 1) * width * height];
+    }
+
+    /** Probability that a ship of the player stays still this turn. */
+    double stay(PlayerId player, Halite cell_halite, Halite ship_halite) const;
+
+   private:
+    static constexpr int BUCKETS = 8;
+    static int bucket(Halite cell_halite, Halite ship_halite);
+
+    struct Sighting {
+        Position position;
+        Halite cell_halite, ship_halite;
+        bool stuck;
+    };
+    std::unordered_map<EntityId, Sighting> last_seen;
+    // Stays and moves by player and bucket.
+    std::vector<std::array<std::array<int, 2>, BUCKETS>> moves;
+
+    int width = 0, height = 0;
+    std::vector<float> occupancy, ships;
+};
+
+}  // namespace hlt
@@ -0,0 +1,131 @@
+#include "opponent_profiler.hpp"
+
+void hlt::OpponentProfiler::update(const Game& game) {
+    const GameMap& game_map = *game.game_map;
+    const int width = game_map.width;
+    const int cells = width * game_map.height;
+    auto index = [&](const Position& p) { return p.y * width + p.x; };
+    auto alive = [&](EntityId id) {
+        auto it = last_seen.find(id);
+        return game.players[it->second.owner]->ships.count(id) > 0;
+    };
+    auto stayed = [&](EntityId id, const Position& p) {
+        auto it = last_seen.find(id);
+        auto& ships = game.players[it->second.owner]->ships;
+        auto now = ships.find(id);
+        return now != ships.end() && now->second->position == p;
+    };
+    // Halite only grows on a cell when a crash drops cargo there.
+    auto gained = [&](const Position& p, Halite before) {
+        return game_map.cells[p.y][p.x].halite > before;
+    };
+    profiles.resize(game.players.size());
+
+    for (auto& it : last_seen) {
+        const Sighting& s = it.second;
+        if (s.owner == game.my_id) continue;
+        const Player& player = *game.players[s.owner];
+        OpponentProfile& profile = profiles[s.owner];
+
+        std::array<Position, 4> near;
+        int n = 0;
+        for (Direction d : ALL_CARDINALS) {
+            const Position q = game_map.normalize(s.position.doff(d));
+            const EntityId other = last_ship[index(q)];
+            if (other >= 0 && last_seen.at(other).owner != s.owner)
+                near[n++] = q;
+        }
+
+        auto now = player.ships.find(it.first);
+        if (now == player.ships.end()) {
+            // Crashed into a neighbour that also disappeared, unless it
+            // became a dropoff. Wrecks drop their cargo, so the cell that
+            // gained halite tells who moved: the ship that moved onto the
+            // other's cell rammed it, and the one that stayed was rammed.
+            // Crashes without cargo cannot be told apart and are skipped.
+            bool rammed = false;
+            bool hit = n && gained(s.position, s.cell_halite);
+            for (int k = 0; k < n; ++k) {
+                const EntityId other = last_ship[index(near[k])];
+                if (alive(other)) continue;
+                rammed |= gained(near[k], last_seen.at(other).cell_halite);
+            }
+            if (rammed || hit) {
+                profile.ram.add(rammed);
+                profile.dodge.add(false);
+            }
+            continue;
+        }
+
+        const Ship& ship = *now->second;
+        const Position p = ship.position;
+        if (n) {
+            // A ram moves onto a ship that stays where it was.
+            bool rammed = false, dodged = p != s.position;
+            for (int k = 0; k < n; ++k) {
+                rammed |= p == near[k] &&
+                          stayed(last_ship[index(near[k])], near[k]);
+                dodged &= game_map.calc_dist(p, near[k]) > 1;
+            }
+            profile.ram.add(rammed);
+            profile.dodge.add(dodged);
+        }
+
+        if (p == s.position && s.cell_halite > 0) {
+            int foreign = 0;
+            for (size_t o = 0; o < last_close.size(); ++o)
+                if (PlayerId(o) != s.owner) foreign += last_close[o][index(p)];
+            profile.inspired.add(foreign >= constants::INSPIRATION_SHIP_COUNT);
+        }
+
+        bool at_base = p == player.shipyard->position;
+        for (auto& dropoff : player.dropoffs)
+            at_base |= p == dropoff.second->position;
+        if (at_base && s.halite > 0 && ship.halite == 0)
+            profile.early_return.add(s.halite < constants::MAX_HALITE / 2);
+    }
+
+    // Remember this frame, touching only the ships that moved, appeared or
+    // disappeared. The buffers start over when the map or players change.
+    const size_t players = game.players.size();
+    if (last_ship.size() != size_t(cells) || last_close.size() != players) {
+        last_seen.clear();
+        last_ship.assign(cells, -1);
+        last_close.assign(players, std::vector<int>(cells));
+    }
+    const int radius = constants::INSPIRATION_RADIUS;
+    auto stamp = [&](PlayerId owner, const Position& p, int count) {
+        std::vector<int>& close = last_close[owner];
+        for (int dy = -radius; dy <= radius; ++dy) {
+            const int r = radius - std::abs(dy);
+            for (int dx = -r; dx <= r; ++dx)
+                close[index(game_map.normalize(
+                    Position(p.x + dx, p.y + dy)))] += count;
+        }
+    };
+
+    for (auto it = last_seen.begin(); it != last_seen.end();) {
+        const Sighting& s = it->second;
+        const auto& ships = game.players[s.owner]->ships;
+        auto now = ships.find(it->first);
+        const bool gone = now == ships.end();
+        if (gone || now->second->position != s.position) {
+            last_ship[index(s.position)] = -1;
+            stamp(s.owner, s.position, -1);
+        }
+        it = gone ? last_seen.erase(it) : std::next(it);
+    }
+    for (auto& player : game.players) {
+        for (auto& it : player->ships) {
+            const Ship& ship = *it.second;
+            const Position p = ship.position;
+            auto seen = last_seen.find(ship.id);
+            if (seen == last_seen.end() || seen->second.position != p) {
+                last_ship[index(p)] = ship.id;
+                stamp(player->id, p, 1);
+            }
+            last_seen[ship.id] = {player->id, p, ship.halite,
+                                  game_map.cells[p.y][p.x].halite};
+        }
+    }
+}
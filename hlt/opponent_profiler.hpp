@@ -0,0 +1,62 @@
+#pragma once
+
+#include "game.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/** A rate over recent events, each weighted DECAY times the next one. */
+struct RollingRate {
+    static constexpr double DECAY = 0.99;
+
+    double events = 0.0, hits = 0.0;
+
+    void add(bool hit) {
+        events = DECAY * events + 1.0;
+        hits = DECAY * hits + hit;
+    }
+    double rate() const { return events ? hits / events : 0.0; }
+};
+
+/** How one player's ships have been behaving. */
+struct OpponentProfile {
+    /** Of turns next to a foreign ship, how often they moved onto it. */
+    RollingRate ram;
+    /** Of turns next to a foreign ship, how often they moved out of reach. */
+    RollingRate dodge;
+    /** Of turns spent mining, how often the cell was inspired. */
+    RollingRate inspired;
+    /** Of deposits, how often the hold was less than half full. */
+    RollingRate early_return;
+};
+
+/**
+ * Builds an OpponentProfile for every player by diffing consecutive frames.
+ * Each update is O(1) per ship, plus restamping the inspiration radius of
+ * the ships that moved.
+ */
+class OpponentProfiler {
+   public:
+    void update(const Game& game);
+
+    const OpponentProfile& operator[](PlayerId player) const {
+        return profiles[player];
+    }
+
+   private:
+    struct Sighting {
+        PlayerId owner;
+        Position position;
+        Halite halite, cell_halite;
+    };
+    std::unordered_map<EntityId, Sighting> last_seen;
+    // The ship on each cell last frame, or -1.
+    std::vector<EntityId> last_ship;
+    // Ships within INSPIRATION_RADIUS of each cell last frame, by player.
+    std::vector<std::vector<int>> last_close;
+
+    std::vector<OpponentProfile> profiles;
+};
+
+}  // namespace hlt
@@ -0,0 +1,8 @@
+#include "reservation_table.hpp"
+
+void hlt::ReservationTable::reset(int width, int height, int depth) {
+    this->width = width;
+    this->height = height;
+    this->depth = depth;
+    slots.assign(size_t(width) * height * depth, {-1, -1});
+}
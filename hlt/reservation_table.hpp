@@ -0,0 +1,46 @@
+#pragma once
+
+#include "position.hpp"
+#include "types.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/**
+ * Which ship holds each cell on each of the next depth turns. Slots form a
+ * ring buffer indexed by turn % depth and remember the turn they were written
+ * for, so reservations for past turns expire without being cleared.
+ */
+struct ReservationTable {
+    int width = 0, height = 0, depth = 0;
+
+    void reset(int width, int height, int depth);
+
+    /** The ship holding p on the given turn, or -1. */
+    EntityId at(const Position& p, int turn) const {
+        const Slot& slot = slots[index(p, turn)];
+        return slot.turn == turn ? slot.ship : -1;
+    }
+    void reserve(const Position& p, int turn, EntityId ship) {
+        slots[index(p, turn)] = {turn, ship};
+    }
+    /** Frees p on the given turn if the ship holds it. */
+    void release(const Position& p, int turn, EntityId ship) {
+        Slot& slot = slots[index(p, turn)];
+        if (slot.turn == turn && slot.ship == ship) slot.turn = -1;
+    }
+
+   private:
+    struct Slot {
+        int turn;
+        EntityId ship;
+    };
+    std::vector<Slot> slots;
+
+    size_t index(const Position& p, int turn) const {
+        return (size_t(turn % depth) * height + p.y) * width + p.x;
+    }
+};
+
+}  // namespace hlt
@@ -0,0 +1,23 @@
+#include "return_schedule.hpp"
+
+std::vector<int> hlt::latest_departures(
+    const std::vector<ReturnRequest>& ships, int last_turn, int capacity) {
+    std::vector<int> order(ships.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int u, int v) {
+        if (ships[u].base != ships[v].base)
+            return ships[u].base < ships[v].base;
+        if (ships[u].dist != ships[v].dist)
+            return ships[u].dist > ships[v].dist;
+        return u < v;
+    });
+
+    // A ship leaving on turn t enters the base on turn t + dist - 1.
+    std::vector<int> departures(ships.size());
+    for (size_t k = 0, first = 0; k < order.size(); ++k) {
+        if (ships[order[k]].base != ships[order[first]].base) first = k;
+        const int entry = last_turn - int(k - first) / capacity;
+        departures[order[k]] = entry - ships[order[k]].dist + 1;
+    }
+    return departures;
+}
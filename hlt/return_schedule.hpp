@@ -0,0 +1,27 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/** A ship that has to be back at one of the bases by the last turn. */
+struct ReturnRequest {
+    int base;
+    int dist;
+};
+
+/**
+ * The latest turn each ship can start its return so that every ship enters
+ * its base by last_turn, when a base takes at most capacity ships per turn.
+ *
+ * This is the time-expanded network of each base: one node per turn with
+ * capacity entries into the base and holdover arcs to later turns, fed by
+ * the ships that can reach the base by that turn. Filling it from the last
+ * turn backwards, farthest ships first, is a maximum flow that also makes
+ * the earliest latest-departure as late as possible. A ship whose turn has
+ * already passed should have started.
+ */
+std::vector<int> latest_departures(const std::vector<ReturnRequest>& ships,
+                                   int last_turn, int capacity);
+
+}  // namespace hlt
@@ -0,0 +1,25 @@
+#include "target_table.hpp"
+
+void hlt::TargetTable::reset(int width, int height, int32_t count) {
+    this->width = width;
+    this->height = height;
+    counts.assign(width * height, count);
+    ordered.clear();
+    total = static_cast<size_t>(count) * width * height;
+    stale = total > 0;
+}
+
+const std::vector<int32_t>& hlt::TargetTable::slots() {
+    if (!stale) return ordered;
+
+    ordered.clear();
+    ordered.reserve(total);
+    for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y) {
+            const int32_t cell = y * width + x;
+            ordered.insert(ordered.end(), counts[cell], cell);
+        }
+    }
+    stale = false;
+    return ordered;
+}
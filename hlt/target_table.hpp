@@ -0,0 +1,53 @@
+#pragma once
+
+#include "position.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/**
+ * The cells explorers can be sent to, each with a multiplicity: the number of
+ * columns it gets in the explorer cost matrix. Counts are kept densely by cell
+ * index y * width + x, so insert, erase and count are O(1).
+ */
+struct TargetTable {
+    int width = 0, height = 0;
+
+    /** Sets the table up for a width x height map with count copies of
+     * every cell. */
+    void reset(int width, int height, int32_t count = 0);
+
+    void insert(const Position& p) {
+        ++counts[index(p)];
+        ++total;
+        stale = true;
+    }
+    /** Removes every copy of p. */
+    void erase(const Position& p) {
+        total -= counts[index(p)];
+        counts[index(p)] = 0;
+        stale = true;
+    }
+    int count(const Position& p) const { return counts[index(p)]; }
+    size_t size() const { return total; }
+
+    /**
+     * One cell index per column, each cell repeated count times, in position
+     * order (by x, then y).
+     */
+    const std::vector<int32_t>& slots();
+
+    int index(const Position& p) const { return p.y * width + p.x; }
+    Position position(int32_t cell) const {
+        return Position(cell % width, cell / width);
+    }
+
+   private:
+    std::vector<int32_t> counts;
+    std::vector<int32_t> ordered;
+    size_t total = 0;
+    bool stale = false;
+};
+
+}  // namespace hlt
@@ -0,0 +1,59 @@
+#include "thread_pool.hpp"
+
+hlt::ThreadPool::ThreadPool(unsigned threads) {
+    for (unsigned i = 0; i + 1 < threads; ++i)
+        workers.emplace_back(&ThreadPool::run, this, i);
+}
+
+hlt::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void hlt::ThreadPool::parallel_for(
+    size_t n, const std::function<void(size_t, unsigned)>& f) {
+    if (workers.empty() || n <= 1) {
+        for (size_t i = 0; i < n; ++i) f(i, workers.size());
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &f;
+        job_size = n;
+        next = 0;
+        busy = workers.size();
+        ++generation;
+    }
+    wake.notify_all();
+
+    work(workers.size());
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busy == 0; });
+    job = nullptr;
+}
+
+void hlt::ThreadPool::work(unsigned thread) {
+    for (size_t i = next++; i < job_size; i = next++) (*job)(i, thread);
+}
+
+void hlt::ThreadPool::run(unsigned thread) {
+    unsigned seen = 0;
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        lock.unlock();
+
+        work(thread);
+
+        lock.lock();
+        if (--busy == 0) done.notify_one();
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/**
+ * A fixed set of worker threads that, together with the calling thread, run
+ * the iterations of a loop whose iterations are independent.
+ */
+class ThreadPool {
+   public:
+    /** Starts threads - 1 workers; the caller is the last thread. */
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+
+    unsigned size() const { return workers.size() + 1; }
+
+    /**
+     * Calls f(i, thread) for every i in [0, n) and returns once all of them
+     * have finished. thread < size() identifies the thread making the call,
+     * so that f can use per-thread scratch space.
+     */
+    void parallel_for(size_t n,
+                      const std::function<void(size_t, unsigned)>& f);
+
+   private:
+    void work(unsigned thread);
+    void run(unsigned thread);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    bool stopping = false;
+    unsigned generation = 0;
+    unsigned busy = 0;
+
+    const std::function<void(size_t, unsigned)>* job = nullptr;
+    size_t job_size = 0;
+    std::atomic<size_t> next{0};
+};
+
+}  // namespace hlt
@@ -0,0 +1,30 @@
+#include "trace.hpp"
+
+constexpr char hlt::TraceWriter::MAGIC[5];
+constexpr uint16_t hlt::TraceWriter::VERSION;
+constexpr size_t hlt::TraceWriter::BUFFER;
+
+void hlt::TraceWriter::open(const std::string& path, PlayerId player,
+                            int width, int height) {
+    file.open(path, std::ios::binary | std::ios::trunc | std::ios::out);
+    if (!file) return;
+
+    TraceHeader header;
+    std::copy(MAGIC, MAGIC + 4, header.magic);
+    header.version = VERSION;
+    header.record_size = sizeof(TraceRecord);
+    header.player = player;
+    header.width = width;
+    header.height = height;
+    header.reserved = 0;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    buffer.reserve(BUFFER);
+}
+
+void hlt::TraceWriter::flush() {
+    if (!is_open() || buffer.empty()) return;
+    file.write(reinterpret_cast<const char*>(buffer.data()),
+               buffer.size() * sizeof(TraceRecord));
+    file.flush();
+    buffer.clear();
+}
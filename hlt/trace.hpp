@@ -0,0 +1,92 @@
+#pragma once
+
+#include "position.hpp"
+#include "types.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/** What a TraceRecord describes. */
+enum TraceKind : uint8_t {
+    /** A highlighted cell; value is a TraceColour. */
+    TRACE_MARK = 0,
+    /** A ship's task (value) and target (tx, ty) for the turn. */
+    TRACE_SHIP = 1,
+    /** A cell a ship could move to, its safety verdict and move cost. */
+    TRACE_OPTION = 2,
+    /** The cell a ship was assigned. */
+    TRACE_MOVE = 3,
+};
+
+enum TraceColour : uint8_t {
+    TRACE_BLUE,
+    TRACE_GREEN,
+    TRACE_RED,
+    TRACE_YELLOW,
+};
+
+enum TraceVerdict : uint8_t {
+    TRACE_SAFE,
+    TRACE_OWN_SHIP,
+    TRACE_ENEMY,
+};
+
+/** One decision, written to disk as is. */
+struct TraceRecord {
+    int16_t turn;
+    TraceKind kind;
+    uint8_t value;
+    int32_t ship;
+    int16_t x, y;
+    int16_t tx, ty;
+    float cost;
+};
+static_assert(sizeof(TraceRecord) == 20, "trace records are 20 bytes");
+
+/** Starts a trace file. */
+struct TraceHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t record_size;
+    int16_t player, width, height, reserved;
+};
+static_assert(sizeof(TraceHeader) == 16, "trace headers are 16 bytes");
+
+/**
+ * Streams TraceRecords to a file through a buffer of BUFFER records, so a
+ * whole game costs no more memory than one buffer. trace_to_flog.py turns
+ * the file into Fluorine JSON.
+ */
+class TraceWriter {
+   public:
+    static constexpr char MAGIC[5] = "HLTR";
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t BUFFER = 4096;
+
+    ~TraceWriter() { flush(); }
+
+    void open(const std::string& path, PlayerId player, int width,
+              int height);
+    bool is_open() const { return file.is_open(); }
+
+    void write(const TraceRecord& record) {
+        if (!is_open()) return;
+        buffer.push_back(record);
+        if (buffer.size() == BUFFER) flush();
+    }
+    void write(int turn, TraceKind kind, uint8_t value, EntityId ship,
+               const Position& p, const Position& target = {-1, -1},
+               float cost = 0.0f) {
+        write(TraceRecord{int16_t(turn), kind, value, ship, int16_t(p.x),
+                          int16_t(p.y), int16_t(target.x),
+                          int16_t(target.y), cost});
+    }
+    void flush();
+
+   private:
+    std::ofstream file;
+    std::vector<TraceRecord> buffer;
+};
+
+}  // namespace hlt
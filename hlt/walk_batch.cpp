@@ -0,0 +1,320 @@
+#include "walk_batch.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WALK_BATCH_AVX2 1
+#endif
+
+using namespace std;
+using namespace hlt;
+using namespace constants;
+
+void WalkGrid::resize(int nx, int ny) {
+    this->nx = nx;
+    this->ny = ny;
+    const size_t cells = (nx + 1) * (ny + 1);
+    halite.resize(cells);
+    safe.resize(cells);
+    inspired.resize(cells);
+    bonus.resize(cells);
+}
+
+static uint32_t lane_seed(uint32_t seed, int lane) {
+    uint32_t s = seed ^ (0x9E3779B9u * (lane + 1));
+    return s ? s : 1;
+}
+
+static uint32_t xorshift(uint32_t& x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static float evaluate(const WalkGrid& grid, int ship, int burned, int turns,
+                      int cell) {
+    const float h = ship - burned + grid.bonus[cell];
+    const float t = max(1, turns);
+    if (grid.explore) return (h - grid.ship_halite) / t;
+    return h / (t * t * t * t);
+}
+
+static void batch_walks_scalar(const WalkGrid& grid, uint32_t seed,
+                               array<BatchWalk, WALK_BATCH>& walks) {
+    const float bonus_multiplier = INSPIRED_BONUS_MULTIPLIER;
+    for (int lane = 0; lane < WALK_BATCH; ++lane) {
+        BatchWalk& walk = walks[lane];
+        uint32_t rng = lane_seed(seed, lane);
+
+        int i = 0, j = 0, cell = 0, burned = 0, turns = 0;
+        int ship = grid.ship_halite, map = grid.halite[0];
+        auto mine = [&]() {
+            int mined = (map + EXTRACT_RATIO - 1) / EXTRACT_RATIO;
+            mined = min(mined, MAX_HALITE - ship);
+            ship += mined;
+            if (grid.inspired[cell]) {
+                ship += static_cast<int>(bonus_multiplier * mined);
+                ship = min(ship, MAX_HALITE);
+            }
+            map -= mined;
+        };
+
+        for (;;) {
+            if (i == grid.nx && j == grid.ny) break;
+            if (turns > 50) break;
+            if (grid.explore && turns && ship > grid.halite_return) break;
+
+            const bool stuck = ship < map / MOVE_COST_RATIO;
+            const int still_ok = map > 0 && grid.safe[cell];
+            const int x_ok =
+                !stuck && i < grid.nx && grid.safe[grid.index(i + 1, j)];
+            const int y_ok =
+                !stuck && j < grid.ny && grid.safe[grid.index(i, j + 1)];
+            const uint32_t count = still_ok + x_ok + y_ok;
+            if (!count) break;
+
+            int k = ((xorshift(rng) >> 16) * count) >> 16;
+            int8_t move = BATCH_Y;
+            if (still_ok && !k--)
+                move = BATCH_STILL;
+            else if (x_ok && !k--)
+                move = BATCH_X;
+            walk.moves[turns++] = move;
+
+            if (move == BATCH_STILL) {
+                mine();
+                continue;
+            }
+            const int burn = map / MOVE_COST_RATIO;
+            ship -= burn;
+            burned += burn;
+            i += move == BATCH_X;
+            j += move == BATCH_Y;
+            cell = grid.index(i, j);
+            map = grid.halite[cell];
+        }
+        walk.length = turns;
+
+        // Final mine.
+        if (grid.turn_number + turns > MAX_TURNS) ship = 0;
+        for (int k = 0; k < 10; ++k) {
+            const float value = evaluate(grid, ship, burned, turns, cell);
+            const int ship_before = ship, map_before = map;
+            ++turns;
+            mine();
+            if (max(0.0f, value) >= evaluate(grid, ship, burned, turns, cell)) {
+                --turns;
+                ship = ship_before;
+                map = map_before;
+                break;
+            }
+        }
+        walk.value = evaluate(grid, ship, burned, turns, cell);
+    }
+}
+
+#ifdef WALK_BATCH_AVX2
+
+#define AVX2 __attribute__((target("avx2")))
+
+namespace {
+
+// Exact floor(h / r) for non-negative h, from a float estimate.
+AVX2 inline __m256i div_avx2(__m256i h, __m256i r, __m256 inverse) {
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i q =
+        _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(h), inverse));
+    __m256i over = _mm256_mullo_epi32(_mm256_add_epi32(q, one), r);
+    q = _mm256_sub_epi32(q, _mm256_cmpgt_epi32(_mm256_add_epi32(h, one), over));
+    q = _mm256_add_epi32(q, _mm256_cmpgt_epi32(_mm256_mullo_epi32(q, r), h));
+    return q;
+}
+
+AVX2 inline __m256i gather_avx2(const vector<int32_t>& v, __m256i index) {
+    return _mm256_i32gather_epi32(v.data(), index, 4);
+}
+
+struct LanesAvx2 {
+    __m256i i, j, cell, ship, map, burned, turns;
+};
+
+AVX2 inline void mine_avx2(const WalkGrid& grid, LanesAvx2& l, __m256i mask) {
+    const __m256i extract = _mm256_set1_epi32(EXTRACT_RATIO);
+    const __m256i max_halite = _mm256_set1_epi32(MAX_HALITE);
+    const __m256 extract_inverse = _mm256_set1_ps(1.0f / EXTRACT_RATIO);
+
+    __m256i mined = div_avx2(
+        _mm256_add_epi32(l.map, _mm256_set1_epi32(EXTRACT_RATIO - 1)), extract,
+        extract_inverse);
+    mined = _mm256_min_epi32(mined, _mm256_sub_epi32(max_halite, l.ship));
+    mined = _mm256_and_si256(mined, mask);
+    l.ship = _mm256_add_epi32(l.ship, mined);
+
+    const __m256i inspired = gather_avx2(grid.inspired, l.cell);
+    const __m256i bonus = _mm256_cvttps_epi32(
+        _mm256_mul_ps(_mm256_set1_ps(INSPIRED_BONUS_MULTIPLIER),
+                      _mm256_cvtepi32_ps(mined)));
+    const __m256i inspired_ship =
+        _mm256_min_epi32(_mm256_add_epi32(l.ship, bonus), max_halite);
+    l.ship = _mm256_blendv_epi8(l.ship, inspired_ship, inspired);
+    l.map = _mm256_sub_epi32(l.map, mined);
+}
+
+AVX2 inline __m256 evaluate_avx2(const WalkGrid& grid, const LanesAvx2& l) {
+    const __m256i h = _mm256_add_epi32(_mm256_sub_epi32(l.ship, l.burned),
+                                       gather_avx2(grid.bonus, l.cell));
+    const __m256 hf = _mm256_cvtepi32_ps(h);
+    const __m256 t = _mm256_cvtepi32_ps(
+        _mm256_max_epi32(l.turns, _mm256_set1_epi32(1)));
+    if (grid.explore) {
+        return _mm256_div_ps(
+            _mm256_sub_ps(hf, _mm256_set1_ps(grid.ship_halite)), t);
+    }
+    const __m256 t2 = _mm256_mul_ps(t, t);
+    return _mm256_div_ps(hf, _mm256_mul_ps(t2, t2));
+}
+
+AVX2 void batch_walks_avx2(const WalkGrid& grid, uint32_t seed,
+                           array<BatchWalk, WALK_BATCH>& walks) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i nx = _mm256_set1_epi32(grid.nx);
+    const __m256i ny = _mm256_set1_epi32(grid.ny);
+    const __m256i stride = _mm256_set1_epi32(grid.ny + 1);
+    const __m256i last = _mm256_set1_epi32(grid.index(grid.nx, grid.ny));
+    const __m256i move_cost = _mm256_set1_epi32(MOVE_COST_RATIO);
+    const __m256 move_cost_inverse = _mm256_set1_ps(1.0f / MOVE_COST_RATIO);
+    const __m256i fifty = _mm256_set1_epi32(50);
+    // ship > halite_return is ship > floor(halite_return) for integers.
+    const __m256i halite_return =
+        _mm256_set1_epi32(static_cast<int>(floor(grid.halite_return)));
+
+    alignas(32) uint32_t seeds[WALK_BATCH];
+    for (int lane = 0; lane < WALK_BATCH; ++lane)
+        seeds[lane] = lane_seed(seed, lane);
+    __m256i rng = _mm256_load_si256(reinterpret_cast<const __m256i*>(seeds));
+
+    LanesAvx2 l;
+    l.i = l.j = l.cell = l.burned = l.turns = zero;
+    l.ship = _mm256_set1_epi32(grid.ship_halite);
+    l.map = _mm256_set1_epi32(grid.halite[0]);
+    __m256i active = _mm256_set1_epi32(-1);
+
+    alignas(32) int32_t moves[52][WALK_BATCH];
+    for (int step = 0; step <= 51; ++step) {
+        __m256i done = _mm256_and_si256(_mm256_cmpeq_epi32(l.i, nx),
+                                        _mm256_cmpeq_epi32(l.j, ny));
+        done = _mm256_or_si256(done, _mm256_cmpgt_epi32(l.turns, fifty));
+        if (grid.explore) {
+            done = _mm256_or_si256(
+                done, _mm256_and_si256(_mm256_cmpgt_epi32(l.turns, zero),
+                                       _mm256_cmpgt_epi32(l.ship,
+                                                          halite_return)));
+        }
+        active = _mm256_andnot_si256(done, active);
+
+        const __m256i stuck =
+            _mm256_cmpgt_epi32(div_avx2(l.map, move_cost, move_cost_inverse),
+                               l.ship);
+        const __m256i still_ok =
+            _mm256_and_si256(_mm256_cmpgt_epi32(l.map, zero),
+                             gather_avx2(grid.safe, l.cell));
+        const __m256i x_cell =
+            _mm256_min_epi32(_mm256_add_epi32(l.cell, stride), last);
+        const __m256i y_cell = _mm256_min_epi32(
+            _mm256_add_epi32(l.cell, _mm256_set1_epi32(1)), last);
+        const __m256i x_ok = _mm256_andnot_si256(
+            stuck, _mm256_and_si256(_mm256_cmpgt_epi32(nx, l.i),
+                                    gather_avx2(grid.safe, x_cell)));
+        const __m256i y_ok = _mm256_andnot_si256(
+            stuck, _mm256_and_si256(_mm256_cmpgt_epi32(ny, l.j),
+                                    gather_avx2(grid.safe, y_cell)));
+        const __m256i count = _mm256_sub_epi32(
+            zero, _mm256_add_epi32(_mm256_add_epi32(still_ok, x_ok), y_ok));
+        active = _mm256_andnot_si256(_mm256_cmpeq_epi32(count, zero), active);
+        if (!_mm256_movemask_epi8(active)) break;
+
+        rng = _mm256_xor_si256(rng, _mm256_slli_epi32(rng, 13));
+        rng = _mm256_xor_si256(rng, _mm256_srli_epi32(rng, 17));
+        rng = _mm256_xor_si256(rng, _mm256_slli_epi32(rng, 5));
+        const __m256i k = _mm256_srli_epi32(
+            _mm256_mullo_epi32(_mm256_srli_epi32(rng, 16), count), 16);
+
+        const __m256i pick_still = _mm256_and_si256(
+            active, _mm256_and_si256(still_ok, _mm256_cmpeq_epi32(k, zero)));
+        const __m256i k_x = _mm256_add_epi32(k, still_ok);
+        const __m256i pick_x = _mm256_andnot_si256(
+            pick_still,
+            _mm256_and_si256(active, _mm256_and_si256(
+                                         x_ok, _mm256_cmpeq_epi32(k_x, zero))));
+        const __m256i pick_y = _mm256_andnot_si256(
+            _mm256_or_si256(pick_still, pick_x), active);
+
+        const __m256i move = _mm256_or_si256(
+            _mm256_and_si256(pick_x, _mm256_set1_epi32(BATCH_X)),
+            _mm256_and_si256(pick_y, _mm256_set1_epi32(BATCH_Y)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(moves[step]), move);
+
+        mine_avx2(grid, l, pick_still);
+
+        const __m256i moving = _mm256_or_si256(pick_x, pick_y);
+        const __m256i burn = _mm256_and_si256(
+            div_avx2(l.map, move_cost, move_cost_inverse), moving);
+        l.ship = _mm256_sub_epi32(l.ship, burn);
+        l.burned = _mm256_add_epi32(l.burned, burn);
+        l.i = _mm256_sub_epi32(l.i, pick_x);
+        l.j = _mm256_sub_epi32(l.j, pick_y);
+        l.cell = _mm256_add_epi32(_mm256_mullo_epi32(l.i, stride), l.j);
+        l.map = _mm256_blendv_epi8(l.map, gather_avx2(grid.halite, l.cell),
+                                   moving);
+        l.turns = _mm256_sub_epi32(l.turns, active);
+    }
+
+    alignas(32) int32_t lengths[WALK_BATCH];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lengths), l.turns);
+
+    // Final mine.
+    const __m256i over = _mm256_cmpgt_epi32(
+        _mm256_add_epi32(l.turns, _mm256_set1_epi32(grid.turn_number)),
+        _mm256_set1_epi32(MAX_TURNS));
+    l.ship = _mm256_andnot_si256(over, l.ship);
+    __m256i mining = _mm256_set1_epi32(-1);
+    for (int k = 0; k < 10 && _mm256_movemask_epi8(mining); ++k) {
+        const __m256 value =
+            _mm256_max_ps(_mm256_setzero_ps(), evaluate_avx2(grid, l));
+        LanesAvx2 next = l;
+        next.turns = _mm256_add_epi32(next.turns, _mm256_set1_epi32(1));
+        mine_avx2(grid, next, mining);
+        mining = _mm256_and_si256(
+            mining, _mm256_castps_si256(_mm256_cmp_ps(
+                        evaluate_avx2(grid, next), value, _CMP_GT_OQ)));
+        l.ship = _mm256_blendv_epi8(l.ship, next.ship, mining);
+        l.map = _mm256_blendv_epi8(l.map, next.map, mining);
+        l.turns = _mm256_blendv_epi8(l.turns, next.turns, mining);
+    }
+
+    alignas(32) float values[WALK_BATCH];
+    _mm256_store_ps(values, evaluate_avx2(grid, l));
+    for (int lane = 0; lane < WALK_BATCH; ++lane) {
+        BatchWalk& walk = walks[lane];
+        walk.length = lengths[lane];
+        walk.value = values[lane];
+        for (int step = 0; step < walk.length; ++step)
+            walk.moves[step] = moves[step][lane];
+    }
+}
+
+}  // namespace
+
+#endif
+
+void hlt::batch_walks(const WalkGrid& grid, uint32_t seed,
+                      array<BatchWalk, WALK_BATCH>& walks) {
+#ifdef WALK_BATCH_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2) {
+        batch_walks_avx2(grid, seed, walks);
+        return;
+    }
+#endif
+    batch_walks_scalar(grid, seed, walks);
+}
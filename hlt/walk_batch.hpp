@@ -0,0 +1,56 @@
+#pragma once
+
+#include "constants.hpp"
+#include "types.hpp"
+
+#include <bits/stdc++.h>
+
+namespace hlt {
+
+/**
+ * The cells a walk can visit between a ship and its target, flattened so that
+ * cell (i, j) is i steps along the ship's x direction and j steps along its y
+ * direction, stored at index(i, j).
+ */
+struct WalkGrid {
+    int nx = -1, ny = -1;
+    /** Halite on the cell. */
+    std::vector<int32_t> halite;
+    /** -1 if the ship may move onto (or stay on) the cell, 0 otherwise. */
+    std::vector<int32_t> safe;
+    /** -1 if mining the cell is inspired, 0 otherwise. */
+    std::vector<int32_t> inspired;
+    /** Halite of an enemy ship really standing on the cell. */
+    std::vector<int32_t> bonus;
+
+    Halite ship_halite;
+    bool explore;
+    int turn_number;
+    double halite_return;
+
+    int index(int i, int j) const { return i * (ny + 1) + j; }
+    void resize(int nx, int ny);
+};
+
+/** Move codes in BatchWalk::moves. */
+enum BatchMove : int8_t { BATCH_STILL = 0, BATCH_X = 1, BATCH_Y = 2 };
+
+struct BatchWalk {
+    std::array<int8_t, 52> moves;
+    int length;
+    double value;
+};
+
+constexpr int WALK_BATCH = 8;
+
+/**
+ * Runs WALK_BATCH independent random walks over the grid, with the same
+ * mining, burning, stopping and final-mine rules as the bot's WalkState. A
+ * walk with no safe move toward the target ends there instead of stepping
+ * sideways. Lanes are simulated together with AVX2 when the host has it; the
+ * scalar path gives identical results.
+ */
+void batch_walks(const WalkGrid& grid, uint32_t seed,
+                 std::array<BatchWalk, WALK_BATCH>& walks);
+
+}  // namespace hlt
@@ -0,0 +1,206 @@
+import argparse
+import json
+import random
+import subprocess
+import sys
+
+# A small stand-in for the Halite III engine, for recording golden transcripts
+# where ./halite is not available. It speaks the engine's protocol and applies
+# spawning, moves, mining with inspiration, collisions, dropoffs and deposits,
+# but its maps are symmetric noise rather than the official generator's, and
+# it skips the engine's finer rules (timeouts, errors, capture). Its games are
+# therefore not the official games of a seed.
+#
+# python3 standin_engine.py --size 32 --seed 588996 ./MyBot ./MyBot
+
+MAX_TURNS = {32: 400, 40: 425, 48: 450, 56: 475, 64: 500}
+DIRECTIONS = {'n': (0, -1), 's': (0, 1), 'e': (1, 0), 'w': (-1, 0)}
+
+
+def constants(size, seed, turns):
+    return {
+        'CAPTURE_ENABLED': False, 'CAPTURE_RADIUS': 3,
+        'DEFAULT_MAP_HEIGHT': size, 'DEFAULT_MAP_WIDTH': size,
+        'DROPOFF_COST': 4000, 'DROPOFF_PENALTY_RATIO': 4, 'EXTRACT_RATIO': 4,
+        'FACTOR_EXP_1': 2.0, 'FACTOR_EXP_2': 2.0, 'INITIAL_ENERGY': 5000,
+        'INSPIRATION_ENABLED': True, 'INSPIRATION_RADIUS': 4,
+        'INSPIRATION_SHIP_COUNT': 2, 'INSPIRED_BONUS_MULTIPLIER': 2.0,
+        'INSPIRED_EXTRACT_RATIO': 4, 'INSPIRED_MOVE_COST_RATIO': 10,
+        'MAX_CELL_PRODUCTION': 1000, 'MAX_ENERGY': 1000, 'MAX_PLAYERS': 16,
+        'MAX_TURNS': turns, 'MAX_TURN_THRESHOLD': 64,
+        'MIN_CELL_PRODUCTION': 900, 'MIN_TURNS': 400,
+        'MIN_TURN_THRESHOLD': 32, 'MOVE_COST_RATIO': 10,
+        'NEW_ENTITY_ENERGY_COST': 1000, 'PERSISTENCE': 0.7,
+        'SHIPS_ABOVE_FOR_CAPTURE': 3, 'STRICT_ERRORS': False,
+        'game_seed': seed}
+
+
+def generate(size, players, rng):
+    # Skewed noise mirrored into four quadrants, with a shipyard per player.
+    halite = [[0] * size for _ in range(size)]
+    for y in range(size // 2):
+        for x in range(size // 2):
+            h = int(rng.random() ** 3 * 1000)
+            for xx, yy in [(x, y), (size - 1 - x, y), (x, size - 1 - y),
+                           (size - 1 - x, size - 1 - y)]:
+                halite[yy][xx] = h
+    near, far = size // 4, size - 1 - size // 4
+    if players == 2:
+        yards = [(near, size // 2), (far, size // 2)]
+    else:
+        yards = [(near, near), (far, near), (near, far), (far, far)]
+    for x, y in yards:
+        halite[y][x] = 0
+    return halite, yards
+
+
+def play(size, seed, turns, bots):
+    rng = random.Random(seed)
+    turns = turns or MAX_TURNS.get(size, 400)
+    halite, yards = generate(size, len(bots), rng)
+    players = [{'id': i, 'yard': yard, 'halite': 5000, 'ships': {},
+                'dropoffs': {}} for i, yard in enumerate(yards)]
+
+    processes = [subprocess.Popen(bot, shell=True, stdin=subprocess.PIPE,
+                                  stdout=subprocess.PIPE,
+                                  universal_newlines=True, bufsize=1)
+                 for bot in bots]
+    init = json.dumps(constants(size, seed, turns)) + '\n'
+    game_map = '{0} {0}\n'.format(size) + ''.join(
+        ' '.join(map(str, row)) + '\n' for row in halite)
+    for i, process in enumerate(processes):
+        process.stdin.write(init + '{} {}\n'.format(len(bots), i) + ''.join(
+            '{} {} {}\n'.format(p['id'], *p['yard']) for p in players) +
+            game_map)
+        process.stdin.flush()
+        process.stdout.readline()
+
+    next_id = 0
+    changed = set()
+    for turn in range(1, turns + 1):
+        frame = '{}\n'.format(turn)
+        for p in players:
+            frame += '{} {} {} {}\n'.format(p['id'], len(p['ships']),
+                                            len(p['dropoffs']), p['halite'])
+            for id, ship in sorted(p['ships'].items()):
+                frame += '{} {} {} {}\n'.format(id, *ship[:3])
+            for id, dropoff in sorted(p['dropoffs'].items()):
+                frame += '{} {} {}\n'.format(id, *dropoff)
+        frame += '{}\n'.format(len(changed)) + ''.join(
+            '{} {} {}\n'.format(x, y, halite[y][x]) for x, y in sorted(changed))
+        changed = set()
+
+        commands = []
+        for i, process in enumerate(processes):
+            process.stdin.write(frame)
+            process.stdin.flush()
+            line = process.stdout.readline()
+            if not line:
+                sys.exit('bot {} died on turn {}'.format(i, turn))
+            commands.append(line.split())
+
+        structures = {}
+        for p in players:
+            structures[p['yard']] = p['id']
+            for dropoff in p['dropoffs'].values():
+                structures[dropoff] = p['id']
+
+        # Ships are [x, y, halite, spawned this turn].
+        moved = set()
+        for p, tokens in zip(players, commands):
+            i = 0
+            while i < len(tokens):
+                if tokens[i] == 'g':
+                    if p['halite'] >= 1000:
+                        p['halite'] -= 1000
+                        p['ships'][next_id] = [p['yard'][0], p['yard'][1], 0,
+                                               True]
+                        next_id += 1
+                    i += 1
+                elif tokens[i] == 'c':
+                    ship = p['ships'].get(int(tokens[i + 1]))
+                    if ship and tuple(ship[:2]) not in structures:
+                        x, y = ship[:2]
+                        cost = 4000 - ship[2] - halite[y][x]
+                        if p['halite'] >= cost:
+                            p['halite'] -= max(0, cost)
+                            halite[y][x] = 0
+                            changed.add((x, y))
+                            p['dropoffs'][int(tokens[i + 1])] = (x, y)
+                            del p['ships'][int(tokens[i + 1])]
+                    i += 2
+                elif tokens[i] == 'm':
+                    id, direction = int(tokens[i + 1]), tokens[i + 2]
+                    i += 3
+                    ship = p['ships'].get(id)
+                    if not ship or direction == 'o' or id in moved:
+                        continue
+                    cost = halite[ship[1]][ship[0]] // 10
+                    if ship[2] < cost:
+                        continue
+                    ship[2] -= cost
+                    dx, dy = DIRECTIONS[direction]
+                    ship[0] = (ship[0] + dx) % size
+                    ship[1] = (ship[1] + dy) % size
+                    moved.add(id)
+                else:
+                    i += 1
+
+        def distance(u, v):
+            dx, dy = abs(u[0] - v[0]), abs(u[1] - v[1])
+            return min(dx, size - dx) + min(dy, size - dy)
+
+        ships = [(p['id'], id, ship) for p in players
+                 for id, ship in p['ships'].items()]
+        for owner, id, ship in ships:
+            if id in moved or ship[3]:
+                ship[3] = False
+                continue
+            x, y = ship[:2]
+            mined = min((halite[y][x] + 3) // 4, 1000 - ship[2])
+            if mined <= 0:
+                continue
+            enemies = sum(1 for other, _, s in ships
+                          if other != owner and distance(s, ship) <= 4)
+            bonus = 2 * mined if enemies >= 2 else 0
+            ship[2] = min(1000, ship[2] + mined + bonus)
+            halite[y][x] -= mined
+            changed.add((x, y))
+
+        cells = {}
+        for owner, id, ship in ships:
+            cells.setdefault(tuple(ship[:2]), []).append((owner, id, ship))
+        for cell, here in cells.items():
+            if len(here) < 2:
+                continue
+            for owner, id, _ in here:
+                del players[owner]['ships'][id]
+            dropped = sum(ship[2] for _, _, ship in here)
+            if cell in structures:
+                players[structures[cell]]['halite'] += dropped
+            else:
+                halite[cell[1]][cell[0]] += dropped
+                changed.add(cell)
+
+        for p in players:
+            for ship in p['ships'].values():
+                if structures.get(tuple(ship[:2])) == p['id']:
+                    p['halite'] += ship[2]
+                    ship[2] = 0
+
+    for process in processes:
+        process.stdin.close()
+        process.wait()
+    return [p['halite'] for p in players]
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--size', type=int, default=32)
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--turns', type=int, default=0,
+                        help='Turns to play; 0 for the size\'s usual length.')
+    parser.add_argument('bots', nargs='+')
+    args = parser.parse_args()
+    print('Scores', ' '.join(map(str, play(args.size, args.seed, args.turns,
+                                            args.bots))))
@@ -1 +1 @@
-zip submit CMakeLists.txt MyBot.* hlt/* hungarian/*
+zip submit CMakeLists.txt MyBot.* hlt/* hungarian/* auction/*
@@ -0,0 +1,73 @@
+#include "hlt/alloc_stats.hpp"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace hlt;
+
+// Checks the counts of the replaced operator new and delete, which this test
+// is always built with: exact counts, bytes and peak on one thread, and that
+// take() sums the slots of threads that have finished.
+
+int failures = 0;
+
+void expect(bool ok, const string& what) {
+    if (ok) return;
+    cerr << "FAIL " << what << '\n';
+    ++failures;
+}
+
+int main() {
+    expect(alloc::enabled(), "enabled");
+
+    vector<void*> blocks;
+    blocks.reserve(100);
+    alloc::take();
+
+    for (int i = 0; i < 10; ++i) blocks.push_back(::operator new(100));
+    const alloc::Counts allocated = alloc::take();
+    for (void* block : blocks) ::operator delete(block);
+    blocks.clear();
+    const alloc::Counts freed = alloc::take();
+    const alloc::Counts idle = alloc::take();
+
+    expect(allocated.allocations == 10 && allocated.frees == 0 &&
+               allocated.bytes == 1000,
+           "counts of 10 new");
+    expect(freed.allocations == 0 && freed.frees == 10 && freed.bytes == 0,
+           "counts of 10 delete");
+    expect(idle.allocations == 0 && idle.frees == 0 && idle.bytes == 0,
+           "counts of nothing");
+    // Each take() starts the peak again at the live bytes.
+    expect(allocated.peak - idle.peak == 1000, "peak while allocated");
+    expect(freed.peak == allocated.peak, "peak carried into the next take");
+
+    alloc::Counts total;
+    total += allocated;
+    total += freed;
+    expect(total.allocations == 10 && total.frees == 10 &&
+               total.peak == allocated.peak,
+           "sum of counts");
+
+    const int THREADS = 4, BLOCKS = 50;
+    vector<thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([] {
+            vector<void*> mine;
+            mine.reserve(BLOCKS);
+            for (int i = 0; i < BLOCKS; ++i) mine.push_back(::operator new(64));
+            for (void* block : mine) ::operator delete(block);
+        });
+    }
+    for (thread& t : threads) t.join();
+    threads.clear();
+    const alloc::Counts threaded = alloc::take();
+    // Starting a thread allocates too.
+    expect(threaded.allocations >= THREADS * (BLOCKS + 1) &&
+               threaded.frees >= THREADS * (BLOCKS + 1) &&
+               threaded.bytes >= THREADS * BLOCKS * 64,
+           "counts of " + to_string(THREADS) + " threads");
+
+    if (failures) cerr << failures << " failures\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+#include "hlt/explore_rates.hpp"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace hlt;
+
+// Checks that explore_rates() gives exactly the scalar path's rates, on random
+// targets over maps of every size, with target counts that leave every tail
+// length for the scalar loop. On hosts without AVX2 both paths are scalar.
+
+int main() {
+    constants::MAX_HALITE = 1000;
+    constants::INSPIRED_BONUS_MULTIPLIER = 2;
+    cout << "AVX2: " << (__builtin_cpu_supports("avx2") ? "yes" : "no")
+         << '\n';
+
+    mt19937 rng(1);
+    auto flag = [&](int percent) {
+        return int(rng() % 100) < percent ? -1 : 0;
+    };
+    int failures = 0;
+    for (int problem = 0; problem < 2000; ++problem) {
+        ExploreTargets t;
+        t.width = t.height = 32 + 8 * (rng() % 5);
+        const size_t n = rng() % 200;
+        t.resize(n);
+
+        vector<int32_t> dist(t.width * t.height);
+        for (int32_t& d : dist) d = rng() % 10 ? rng() % 200 : 1000;
+        for (size_t k = 0; k < n; ++k) {
+            t.x[k] = rng() % t.width;
+            t.y[k] = rng() % t.height;
+            t.cell[k] = t.y[k] * t.width + t.x[k];
+            t.halite[k] = rng() % 1001;
+            t.base_dist[k] = rng() % t.width;
+            for (vector<int32_t>& arrival : t.inspired)
+                arrival[k] = flag(20);
+            t.future_inspired[k] = flag(10);
+            t.enemy_halite[k] = rng() % 4 ? -1 : int32_t(rng() % 1001);
+            t.neighbourhood[k] = rng() % 500;
+        }
+
+        const int x = rng() % t.width, y = rng() % t.height;
+        const Halite ship_halite = rng() % 1001;
+        const bool future_inspire = rng() % 2;
+        vector<float> rates, expected;
+        explore_rates(t, x, y, ship_halite, future_inspire, dist, rates);
+        explore_rates_scalar(t, x, y, ship_halite, future_inspire, dist,
+                             expected);
+        if (rates != expected) {
+            cerr << "FAIL problem " << problem << '\n';
+            ++failures;
+        }
+    }
+
+    if (failures) cerr << failures << " failures\n";
+    return failures ? 1 : 0;
+}
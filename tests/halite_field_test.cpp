@@ -0,0 +1,73 @@
+#include "hlt/halite_field.hpp"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace hlt;
+
+// Checks HaliteField against box sums computed cell by cell, over frames that
+// change a few cells (incremental updates) or most of them (rebuilds), and
+// across map size changes. Small maps cap the radii.
+
+int32_t box_sum(const GameMap& map, int x, int y, int r) {
+    int32_t total = 0;
+    for (int dy = -r; dy <= r; ++dy) {
+        for (int dx = -r; dx <= r; ++dx) {
+            total += map.cells[(y + dy + map.height) % map.height]
+                              [(x + dx + map.width) % map.width]
+                                  .halite;
+        }
+    }
+    return total;
+}
+
+int main() {
+    mt19937 rng(1);
+    const vector<pair<int, int>> sizes = {
+        {32, 32}, {40, 40}, {64, 64}, {5, 5}, {12, 20}, {32, 32}};
+    HaliteField field;
+    int failures = 0;
+    for (const pair<int, int>& size : sizes) {
+        GameMap map;
+        map.width = size.first;
+        map.height = size.second;
+        for (int y = 0; y < map.height; ++y) {
+            map.cells.emplace_back();
+            for (int x = 0; x < map.width; ++x)
+                map.cells[y].emplace_back(x, y, rng() % 1001);
+        }
+
+        for (int frame = 0; frame < 40; ++frame) {
+            if (frame) {
+                map.changed.clear();
+                const int cells = map.width * map.height;
+                const int changes = frame % 10 ? rng() % 8 : rng() % cells;
+                for (int c = 0; c < changes; ++c) {
+                    const Position p(rng() % map.width, rng() % map.height);
+                    map.cells[p.y][p.x].halite = rng() % 1001;
+                    map.changed.push_back(p);
+                }
+            }
+            field.update(map);
+
+            for (int s = 0; s < HaliteField::SCALES; ++s) {
+                const int r = min(HaliteField::RADII[s],
+                                  (min(map.width, map.height) - 1) / 2);
+                for (int y = 0; y < map.height; ++y) {
+                    for (int x = 0; x < map.width; ++x) {
+                        if (field.sum(Position(x, y), s) ==
+                            box_sum(map, x, y, r))
+                            continue;
+                        cerr << "FAIL " << map.width << 'x' << map.height
+                             << " frame " << frame << " scale " << s << " at "
+                             << x << ',' << y << '\n';
+                        ++failures;
+                    }
+                }
+            }
+        }
+    }
+
+    if (failures) cerr << failures << " failures\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,82 @@
+#include "hlt/fleet_stats.hpp"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace hlt;
+
+// Checks QuantileSketch against exact quantiles of the values in its window:
+// the values of the current block of turns and the BLOCKS - 1 before it. A
+// quantile must lie within a factor sqrt(GAMMA) of the exact one, the middle
+// of the exact value's bin, and values below 1 read as 0.
+
+int main() {
+    using Sketch = QuantileSketch;
+    const double bound = sqrt(Sketch::GAMMA) * (1 + 1e-9);
+    const vector<double> qs = {0.0, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 1.0};
+
+    mt19937 rng(1);
+    int failures = 0;
+    for (int stream = 0; stream < 4; ++stream) {
+        Sketch sketch;
+        deque<pair<int, double>> window;
+        for (int turn = 0; turn < 500; ++turn) {
+            // Some turns see nothing, so that blocks expire empty too.
+            const int values = turn % 60 < 45 ? rng() % 4 : 0;
+            for (int v = 0; v < values; ++v) {
+                double value;
+                switch (stream) {
+                    case 0: value = 1 + rng() % 1000; break;
+                    case 1:
+                        value = exponential_distribution<>(0.05)(rng);
+                        break;
+                    case 2: value = rng() % 6; break;
+                    default: value = pow(10.0, 4.0 * (rng() % 1000) / 1e3);
+                }
+                sketch.add(turn, value);
+                window.emplace_back(turn, value);
+            }
+            sketch.advance(turn);
+
+            const int oldest =
+                (turn / Sketch::BLOCK_TURNS - Sketch::BLOCKS + 1) *
+                Sketch::BLOCK_TURNS;
+            while (!window.empty() && window.front().first < oldest)
+                window.pop_front();
+
+            vector<double> exact;
+            double sum = 0;
+            for (const pair<int, double>& entry : window) {
+                exact.push_back(entry.second);
+                sum += entry.second;
+            }
+            sort(exact.begin(), exact.end());
+            const int n = exact.size();
+            if (sketch.count() != n ||
+                (n && abs(sketch.mean() - sum / n) > 1e-6 * (1 + sum / n))) {
+                cerr << "FAIL stream " << stream << " turn " << turn
+                     << ": count " << sketch.count() << " expected " << n
+                     << '\n';
+                ++failures;
+                continue;
+            }
+            if (!n) continue;
+
+            for (double q : qs) {
+                const double expected = exact[min<int>(n - 1, q * n)];
+                const double got = sketch.quantile(q);
+                const bool ok = expected < 1 ? got == 0
+                                             : got <= expected * bound &&
+                                                   got * bound >= expected;
+                if (ok) continue;
+                cerr << "FAIL stream " << stream << " turn " << turn
+                     << " quantile " << q << ": " << got << " expected "
+                     << expected << '\n';
+                ++failures;
+            }
+        }
+    }
+
+    if (failures) cerr << failures << " failures\n";
+    return failures ? 1 : 0;
+}
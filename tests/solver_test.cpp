@@ -0,0 +1,96 @@
+#include "auction/Auction.h"
+#include "hungarian/Hungarian.h"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace chrono;
+
+// Checks the auction solver against the Hungarian one: on random problems,
+// and on explorer cost matrices dumped from real turns (MyBot --dump-costs),
+// which are passed as arguments. Both must find the same total cost to within
+// the auction's resolution, and the auction must stay within the turn budget.
+
+const double MAX_MILLIS = 250;
+
+int failures = 0;
+
+void fail(const string& what) {
+    cerr << "FAIL " << what << '\n';
+    ++failures;
+}
+
+bool distinct(const vector<int>& assignment, size_t columns) {
+    vector<bool> used(columns);
+    for (int j : assignment) {
+        if (j < 0) continue;
+        if (size_t(j) >= columns || used[j]) return false;
+        used[j] = true;
+    }
+    return true;
+}
+
+// Solves cost both ways and returns the auction's time in milliseconds.
+double compare(const string& name, vector<vector<double>> cost) {
+    vector<vector<double>> copy = cost;
+    vector<int> hungarian, auction;
+    const double expected = HungarianAlgorithm().Solve(copy, hungarian);
+
+    const auto begin = steady_clock::now();
+    const double total = AuctionAlgorithm().Solve(cost, auction);
+    const double millis =
+        duration_cast<microseconds>(steady_clock::now() - begin).count() /
+        1e3;
+
+    const size_t columns = cost.empty() ? 0 : cost[0].size();
+    const size_t assigned = min(cost.size(), columns);
+    if (!distinct(auction, columns) ||
+        size_t(count_if(auction.begin(), auction.end(),
+                        [](int j) { return j >= 0; })) != assigned) {
+        fail(name + ": not an assignment");
+    }
+    if (total > expected + AuctionAlgorithm::RESOLUTION) {
+        fail(name + ": auction " + to_string(total) + " hungarian " +
+             to_string(expected));
+    }
+    return millis;
+}
+
+vector<vector<double>> read_matrix(const string& path) {
+    ifstream in(path);
+    size_t rows = 0, columns = 0;
+    in >> rows >> columns;
+    vector<vector<double>> cost(rows, vector<double>(columns));
+    for (vector<double>& row : cost)
+        for (double& c : row) in >> c;
+    if (!in) fail(path + ": unreadable");
+    return cost;
+}
+
+int main(int argc, char* argv[]) {
+    // Small random problems, square and rectangular both ways, with many
+    // ties among integer costs.
+    mt19937 rng(1);
+    for (int problem = 0; problem < 3000; ++problem) {
+        const size_t rows = 1 + rng() % 12, columns = 1 + rng() % 16;
+        const int range = problem % 2 ? 5 : 1000;
+        vector<vector<double>> cost(rows, vector<double>(columns));
+        for (vector<double>& row : cost)
+            for (double& c : row) c = rng() % range;
+        compare("random problem " + to_string(problem), cost);
+    }
+
+    double total = 0, worst = 0;
+    for (int i = 1; i < argc; ++i) {
+        const double millis = compare(argv[i], read_matrix(argv[i]));
+        total += millis;
+        worst = max(worst, millis);
+        if (millis > MAX_MILLIS)
+            fail(string(argv[i]) + ": took " + to_string(millis) + " ms");
+    }
+    cout << argc - 1 << " dumped matrices, auction " << total << " ms total, "
+         << worst << " ms worst\n";
+
+    if (failures) cerr << failures << " failures\n";
+    return failures ? 1 : 0;
+}
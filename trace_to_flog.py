@@ -0,0 +1,78 @@
+import argparse
+import json
+import struct
+import sys
+
+# Converts a bot-<id>-<pid>.trace (or --trace-path) written by MyBot into
+# Fluorine JSON. Marks keep their colour; ship, option and move records become
+# messages on their cells.
+#
+# python3 trace_to_flog.py bot-0-1234.trace > __flog.json
+# python3 trace_to_flog.py bot-0-1234.trace --ship 12 --turns 100-120 > s.json
+
+HEADER = struct.Struct('<4sHHhhhh')
+RECORD = struct.Struct('<hBBihhhhf')
+
+MARK, SHIP, OPTION, MOVE = range(4)
+COLOURS = ['blue', 'green', 'red', 'yellow']
+TASKS = {1: 'explore', 2: 'return', 4: 'hard return'}
+VERDICTS = ['safe', 'own ship', 'enemy']
+
+
+def records(path):
+    with open(path, 'rb') as trace:
+        magic, version, size = HEADER.unpack(trace.read(HEADER.size))[:3]
+        if magic != b'HLTR' or version != 1 or size != RECORD.size:
+            sys.exit('{}: not a version 1 trace'.format(path))
+        while True:
+            data = trace.read(RECORD.size)
+            if len(data) < RECORD.size:
+                return
+            yield RECORD.unpack(data)
+
+
+def entry(record):
+    turn, kind, value, ship, x, y, tx, ty, cost = record
+    flog = {'t': turn, 'x': x, 'y': y}
+    if kind == MARK:
+        flog['color'] = COLOURS[value]
+    elif kind == SHIP:
+        flog['msg'] = 'ship {} {} to ({}, {})'.format(
+            ship, TASKS.get(value, value), tx, ty)
+    elif kind == OPTION:
+        flog['msg'] = 'ship {} option {} cost {:g}'.format(
+            ship, VERDICTS[value], cost)
+    elif kind == MOVE:
+        flog['msg'] = 'ship {} moves here'.format(ship)
+    return flog
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('trace')
+    parser.add_argument('--ship', type=int, help='only this ship')
+    parser.add_argument('--turns', help='first-last turn to keep')
+    parser.add_argument('--marks', action='store_true',
+                        help='only highlighted cells, like the old flog')
+    args = parser.parse_args()
+
+    first, last = 0, 1 << 15
+    if args.turns:
+        first, last = map(int, args.turns.split('-'))
+
+    entries = []
+    for record in records(args.trace):
+        turn, kind, _, ship = record[:4]
+        if not first <= turn <= last:
+            continue
+        if args.marks and kind != MARK:
+            continue
+        if args.ship is not None and ship != args.ship:
+            continue
+        entries.append(entry(record))
+    json.dump(entries, sys.stdout, indent=0)
+    sys.stdout.write('\n')
+
+
+if __name__ == '__main__':
+    main()